@@ -2,6 +2,8 @@
 #include "Console.hpp"
 #include "simdjson/simdjson.h"
 #include "timestamp.hpp"
+#include "Coroutines/FramePool.hpp"
+#include <algorithm>
 
 extern "C"
 {
@@ -24,6 +26,41 @@ namespace CrescendoEngine
 		}
 		return result;
 	}
+	// Flattens element into settings, nested keys are joined with '.' and array elements use their index
+	void FlattenSettings(simdjson::dom::element element, const std::string& key, Settings& settings)
+	{
+		switch (element.type())
+		{
+		case simdjson::dom::element_type::OBJECT:
+			for (auto [childKey, child] : element.get_object().value())
+				FlattenSettings(child, key.empty() ? std::string(childKey) : key + "." + std::string(childKey), settings);
+			break;
+		case simdjson::dom::element_type::ARRAY:
+		{
+			size_t index = 0;
+			for (simdjson::dom::element child : element.get_array().value())
+				FlattenSettings(child, key + "." + std::to_string(index++), settings);
+			break;
+		}
+		case simdjson::dom::element_type::INT64:
+			settings.Set(key, element.get_int64().value());
+			break;
+		case simdjson::dom::element_type::UINT64:
+			settings.Set(key, static_cast<int64_t>(element.get_uint64().value()));
+			break;
+		case simdjson::dom::element_type::DOUBLE:
+			settings.Set(key, element.get_double().value());
+			break;
+		case simdjson::dom::element_type::BOOL:
+			settings.Set(key, element.get_bool().value());
+			break;
+		case simdjson::dom::element_type::STRING:
+			settings.Set(key, std::string(element.get_string().value()));
+			break;
+		case simdjson::dom::element_type::NULL_VALUE:
+			break;
+		}
+	}
 	Core* Core::s_instance = nullptr;
 	std::string Core::LoadConfig(const std::filesystem::path& path)
 	{
@@ -42,8 +79,63 @@ namespace CrescendoEngine
 		if (!doc["entrypoint"].is_string())
 			Console::Fatal<std::runtime_error>("Config file is missing entrypoint field");
 
+		// Settings are optional, but must be an object when present
+		m_settings.Clear();
+		simdjson::dom::element settings;
+		if (!doc["settings"].get(settings))
+		{
+			if (!settings.is_object())
+				Console::Fatal<std::runtime_error>("Config file settings field must be an object");
+			FlattenSettings(settings, "", m_settings);
+		}
+
 		return std::string(doc["entrypoint"].get_string().value());
 	}
+	void Core::ApplyCapacitySettings()
+	{
+		if (auto workers = m_settings.Find<int64_t>("threads.workers"))
+		{
+			if (*workers < 0)
+				Console::Warn("Ignoring negative threads.workers setting");
+			else
+				m_threadPool.SetThreadCount(static_cast<size_t>(*workers));
+		}
+		Console::Log("Worker threads: ", m_threadPool.GetThreadCount());
+
+		if (auto entities = m_settings.Find<int64_t>("reserve.entities"); entities && *entities > 0)
+			m_entityRegistry.ReserveEntities(static_cast<size_t>(*entities));
+		if (auto hierarchy = m_settings.Find<int64_t>("reserve.hierarchy"); hierarchy && *hierarchy > 0)
+			m_entityRegistry.GetTransformHierarchy().Reserve(static_cast<size_t>(*hierarchy));
+
+		const int64_t frameSize = m_settings.Get<int64_t>("arenas.coroutineFrames.size", 0);
+		const int64_t frameCount = m_settings.Get<int64_t>("arenas.coroutineFrames.count", 0);
+		if (frameSize > 0 && frameCount > 0)
+			FramePool::Reserve(static_cast<size_t>(frameSize), static_cast<size_t>(frameCount));
+	}
+	void Core::ApplyComponentReservations()
+	{
+		m_settings.ForEachWithPrefix("reserve.components.", [this](std::string_view name, const Settings::Value& value) {
+			const int64_t* count = std::get_if<int64_t>(&value);
+			if (count == nullptr || *count < 0)
+				Console::Warn("Ignoring reserve.components.", name, ", expected a non-negative integer");
+			else if (!m_entityRegistry.ReserveComponents(name, static_cast<size_t>(*count)))
+				Console::Warn("Ignoring reserve.components.", name, ", no component is registered with that name");
+		});
+	}
+	uint32_t Core::AllocateServiceSlot(entt::id_type typeHash)
+	{
+		auto [it, inserted] = m_serviceSlots.try_emplace(typeHash, static_cast<uint32_t>(m_serviceSlots.size()));
+		if (inserted && it->second >= MAX_SERVICES)
+			Console::Fatal<std::runtime_error>("Too many service interfaces registered, the limit is ", MAX_SERVICES);
+		return it->second;
+	}
+	void** Core::FindServiceSlot(entt::id_type typeHash)
+	{
+		auto it = m_serviceSlots.find(typeHash);
+		if (it == m_serviceSlots.end())
+			return nullptr;
+		return &m_services[it->second];
+	}
 	void Core::LoadModule(
 		const std::filesystem::path& path, std::vector<ModuleData>& modules,
 		std::unordered_set<std::string>& loadingModules, std::unordered_set<std::string>& loadedModules
@@ -119,6 +211,168 @@ namespace CrescendoEngine
 			instance->OnLoad();
 		}
 	}
+	void Core::BuildUpdateOrder(const std::vector<ModuleData>& modules)
+	{
+		// Modules are loaded dependencies first, so load order is already a topological order
+		std::unordered_map<std::string, uint32_t> indices;
+		std::vector<std::vector<uint32_t>> dependents(modules.size());
+		m_updateOrder.clear();
+		m_updateOrder.reserve(modules.size());
+		for (const auto& module : modules)
+		{
+			const ModuleMetadata metadata = module.getMetadata();
+			const uint32_t index = static_cast<uint32_t>(m_updateOrder.size());
+			indices[metadata.name] = index;
+
+			uint32_t dependencyCount = 0;
+			for (const auto& dependencyName : ParseDependencies(metadata.dependencies))
+			{
+				auto it = indices.find(dependencyName);
+				if (it == indices.end())
+				{
+					Console::Warn("Module ", metadata.name, " depends on ", dependencyName, " which is not loaded, ignoring for update ordering");
+					continue;
+				}
+				dependents[it->second].push_back(index);
+				dependencyCount++;
+			}
+			m_updateOrder.push_back({ m_loadedModules.at(metadata.name).module.get(), metadata.updateAffinity, dependencyCount, 0, 0 });
+		}
+
+		// Flatten the dependents into one contiguous array
+		m_dependents.clear();
+		for (size_t i = 0; i < m_updateOrder.size(); i++)
+		{
+			m_updateOrder[i].firstDependent = static_cast<uint32_t>(m_dependents.size());
+			m_updateOrder[i].dependentCount = static_cast<uint32_t>(dependents[i].size());
+			m_dependents.insert(m_dependents.end(), dependents[i].begin(), dependents[i].end());
+		}
+		m_remainingDependencies.resize(m_updateOrder.size());
+	}
+	void Core::RunAnyThreadUpdate(uint32_t index)
+	{
+		std::exception_ptr error;
+		try { m_updateOrder[index].module->OnUpdate(m_updateDt); }
+		catch (...) { error = std::current_exception(); }
+		std::scoped_lock lock(m_updateMutex);
+		if (error && !m_updateException)
+			m_updateException = error;
+		m_finishedUpdates.push_back(index);
+		m_updateCondition.notify_one();
+	}
+	void Core::UpdateModules(double dt)
+	{
+		// Ready modules are started lowest table index first, keeping the order deterministic when nothing runs concurrently
+		m_readyUpdates.clear();
+		for (uint32_t i = 0; i < m_updateOrder.size(); i++)
+		{
+			m_remainingDependencies[i] = m_updateOrder[i].dependencyCount;
+			if (m_updateOrder[i].dependencyCount == 0)
+				m_readyUpdates.push_back(i);
+		}
+		std::make_heap(m_readyUpdates.begin(), m_readyUpdates.end(), std::greater<uint32_t>());
+		m_updateDt = dt;
+		m_updateException = nullptr;
+		// Only touched by the main thread
+		std::exception_ptr exception;
+
+		size_t completed = 0;
+		// AnyThread nodes handed to the workers and not drained yet
+		size_t inFlight = 0;
+		auto onFinished = [&](uint32_t index) {
+			completed++;
+			const UpdateNode& node = m_updateOrder[index];
+			for (uint32_t i = node.firstDependent; i < node.firstDependent + node.dependentCount; i++)
+			{
+				if (--m_remainingDependencies[m_dependents[i]] == 0)
+				{
+					m_readyUpdates.push_back(m_dependents[i]);
+					std::push_heap(m_readyUpdates.begin(), m_readyUpdates.end(), std::greater<uint32_t>());
+				}
+			}
+		};
+		auto waitForWorkers = [&] {
+			{
+				std::unique_lock lock(m_updateMutex);
+				// The pool queue is shared with jobs and ParallelFor, rather than idling behind them the main thread
+				// runs the AnyThread nodes no worker has claimed yet
+				while (m_finishedUpdates.empty() && !m_pendingUpdates.empty() && !exception)
+				{
+					const uint32_t index = m_pendingUpdates.back();
+					m_pendingUpdates.pop_back();
+					lock.unlock();
+					RunAnyThreadUpdate(index);
+					lock.lock();
+				}
+				m_updateCondition.wait(lock, [this] { return !m_finishedUpdates.empty(); });
+				m_drainedUpdates.swap(m_finishedUpdates);
+				if (m_updateException && !exception)
+					exception = m_updateException;
+			}
+			inFlight -= m_drainedUpdates.size();
+			for (uint32_t index : m_drainedUpdates)
+				onFinished(index);
+			m_drainedUpdates.clear();
+		};
+
+		while (completed < m_updateOrder.size() && !exception)
+		{
+			while (!m_readyUpdates.empty() && !exception)
+			{
+				std::pop_heap(m_readyUpdates.begin(), m_readyUpdates.end(), std::greater<uint32_t>());
+				const uint32_t index = m_readyUpdates.back();
+				m_readyUpdates.pop_back();
+				const UpdateNode& node = m_updateOrder[index];
+				if (node.affinity == UpdateAffinity::AnyThread && m_threadPool.GetThreadCount() > 0)
+				{
+					inFlight++;
+					{
+						std::scoped_lock lock(m_updateMutex);
+						m_pendingUpdates.push_back(index);
+					}
+					// One job per node, a job finding nothing pending lost its node to the main thread or another job.
+					// Capturing only this keeps the task within the std::function small buffer
+					m_threadPool.Submit([this] {
+						uint32_t index;
+						{
+							std::scoped_lock lock(m_updateMutex);
+							if (m_pendingUpdates.empty())
+								return;
+							index = m_pendingUpdates.back();
+							m_pendingUpdates.pop_back();
+						}
+						RunAnyThreadUpdate(index);
+					});
+					continue;
+				}
+				try
+				{
+					node.module->OnUpdate(dt);
+				}
+				catch (...)
+				{
+					exception = std::current_exception();
+					break;
+				}
+				onFinished(index);
+			}
+			// Everything runnable is on a worker, help run it or wait for at least one to finish
+			if (completed < m_updateOrder.size() && !exception)
+				waitForWorkers();
+		}
+
+		// On failure the unclaimed nodes are dropped, the running ones must finish before the next tick reuses the state
+		if (exception)
+		{
+			std::scoped_lock lock(m_updateMutex);
+			inFlight -= m_pendingUpdates.size();
+			m_pendingUpdates.clear();
+		}
+		while (inFlight > 0)
+			waitForWorkers();
+		if (exception)
+			std::rethrow_exception(exception);
+	}
 	void Core::MainLoop()
 	{
 		bool running = true;
@@ -149,10 +403,11 @@ namespace CrescendoEngine
 
 			while (accumulator >= 0.5)
 			{
-				for (auto& [moduleName, module] : m_loadedModules)
-				{
-					module.module->OnUpdate(0.5);
-				}
+				m_resourceService.Update();
+				UpdateModules(0.5);
+				m_worldManager.Step(0.5);
+				m_scheduler.Update(0.5);
+				m_entityRegistry.GetTransformHierarchy().Propagate(&m_threadPool);
 				accumulator -= 0.5;
 			}
 		}
@@ -161,8 +416,18 @@ namespace CrescendoEngine
 	}
 	void Core::UnloadModules()
 	{
-		for (auto& [moduleName, module] : m_loadedModules)
-			module.module->OnUnload();
+		// Pending callbacks and parsers may live in module code
+		m_resourceService.CancelAll();
+		m_scheduler.CancelAll();
+		// Dependents are unloaded before their dependencies
+		for (auto it = m_updateOrder.rbegin(); it != m_updateOrder.rend(); it++)
+			it->module->OnUnload();
+		// World systems, component pools and name reservers hold code from the modules, and modules may still use
+		// their worlds and entities in OnUnload
+		m_worldManager.Clear();
+		m_entityRegistry.Clear();
+		m_updateOrder.clear();
+		m_dependents.clear();
 		for (auto& [moduleName, module] : m_loadedModules)
 		{
 			if (module.module)
@@ -172,7 +437,7 @@ namespace CrescendoEngine
 		}
 		m_loadedModules.clear();
 	}
-	Core::Core()
+	Core::Core() : m_scheduler(m_threadPool), m_worldManager(m_threadPool)
 	{
 		if (s_instance)
 			Console::Fatal<std::runtime_error>("Core instance already exists");
@@ -190,17 +455,40 @@ namespace CrescendoEngine
 		std::unordered_set<std::string> loadingModules;
 		std::unordered_set<std::string> loadedModules;
 
+		ApplyCapacitySettings();
 		LoadModule(entrypoint, modules, loadingModules, loadedModules);
 		InitializeModules(modules);
+		ApplyComponentReservations();
+		BuildUpdateOrder(modules);
 		MainLoop();
 		UnloadModules();
 
 		Console::Log("Core Shutdown, total time: ", static_cast<double>(Console::End<std::chrono::milliseconds>()) / 1000.0, "s");
 	}
+	const Settings& Core::GetSettings() const
+	{
+		return m_settings;
+	}
 	EntityRegistry& Core::GetEntityRegistry()
 	{
 		return m_entityRegistry;
 	}
+	ThreadPool& Core::GetThreadPool()
+	{
+		return m_threadPool;
+	}
+	ResourceService& Core::GetResourceService()
+	{
+		return m_resourceService;
+	}
+	CoroutineScheduler& Core::GetScheduler()
+	{
+		return m_scheduler;
+	}
+	WorldManager& Core::GetWorldManager()
+	{
+		return m_worldManager;
+	}
 	void Core::RequestShutdown()
 	{
 		Console::Log("Shutting down (does nothing)");
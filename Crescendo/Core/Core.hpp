@@ -1,11 +1,22 @@
 #pragma once
 #include "Interfaces/Module.hpp"
+#include "Interfaces/Service.hpp"
 #include <vector>
 #include <memory>
 #include <filesystem>
 #include <string>
 #include <unordered_set>
+#include <unordered_map>
+#include <array>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
 #include "ECS/EntityRegistry.hpp"
+#include "Threading/ThreadPool.hpp"
+#include "Resources/ResourceService.hpp"
+#include "Coroutines/CoroutineScheduler.hpp"
+#include "Worlds/WorldManager.hpp"
+#include "Settings.hpp"
 #include "OSDetection.hpp"
 
 namespace CrescendoEngine
@@ -15,6 +26,9 @@ namespace CrescendoEngine
 
 	class CS_CORE_EXPORT Core
 	{
+	public:
+		// Maximum number of distinct service interfaces, slots are fixed so handles never dangle
+		static constexpr size_t MAX_SERVICES = 256;
 	private:
 		struct ModuleData
 		{
@@ -23,34 +37,125 @@ namespace CrescendoEngine
 			GetMetadataFunc getMetadata = nullptr;
 			std::unique_ptr<Module> module;
 		};
+		// Entry in the topologically sorted update table, dependencies always come before their dependents
+		struct UpdateNode
+		{
+			Module* module;
+			UpdateAffinity affinity;
+			uint32_t dependencyCount;
+			// Range into m_dependents
+			uint32_t firstDependent;
+			uint32_t dependentCount;
+		};
 	private:
 		static Core* s_instance;
 	private:
 		std::unordered_map<std::string, ModuleData> m_loadedModules;
+		Settings m_settings;
+		// Per tick update state, reused between ticks. Declared before m_threadPool, a queued update job whose module
+		// was already run inline by the main thread still locks the mutex when the pool drains its queue
+		std::mutex m_updateMutex;
+		std::condition_variable m_updateCondition;
+		// Ready AnyThread modules not yet claimed by a worker or the main thread, guarded by m_updateMutex
+		std::vector<uint32_t> m_pendingUpdates;
+		// Modules finished on a worker, guarded by m_updateMutex
+		std::vector<uint32_t> m_finishedUpdates;
+		std::exception_ptr m_updateException;
+		double m_updateDt = 0.0;
+		ThreadPool m_threadPool;
 		EntityRegistry m_entityRegistry;
+		ResourceService m_resourceService;
+		CoroutineScheduler m_scheduler;
+		WorldManager m_worldManager;
+		std::vector<UpdateNode> m_updateOrder;
+		std::vector<uint32_t> m_dependents;
+		// Per tick scratch, number of unfinished dependencies of each node
+		std::vector<uint32_t> m_remainingDependencies;
+		// Per tick scratch, min-heap of ready nodes and the finished nodes drained from the workers
+		std::vector<uint32_t> m_readyUpdates;
+		std::vector<uint32_t> m_drainedUpdates;
+		// Service pointers, indexed by slot
+		std::array<void*, MAX_SERVICES> m_services = {};
+		// Interface type hash to slot, only used when resolving
+		std::unordered_map<entt::id_type, uint32_t> m_serviceSlots;
 	private:
 		// Loads a configuration file and returns the entrypoint module
 		std::string LoadConfig(const std::filesystem::path& path);
+		// Applies the thread, entity and arena capacity hints, before any module is loaded
+		void ApplyCapacitySettings();
+		// Applies the per component reservation hints, after modules have registered their component names
+		void ApplyComponentReservations();
+		// Returns the slot for an interface type hash, allocating one on first use. Only called while registering
+		uint32_t AllocateServiceSlot(entt::id_type typeHash);
+		// Returns the slot of an interface type hash, or nullptr if no provider was ever registered. Never writes
+		void** FindServiceSlot(entt::id_type typeHash);
 		// Loads the entrypoint module and all the dependencies
 		void LoadModule(
 			const std::filesystem::path& path, std::vector<ModuleData>& modules,
 			std::unordered_set<std::string>& loadingModules, std::unordered_set<std::string>& loadedModules
 		);
 		void InitializeModules(const std::vector<ModuleData>& modules);
+		// Builds the update table from the modules in load order
+		void BuildUpdateOrder(const std::vector<ModuleData>& modules);
+		// Calls OnUpdate on every module, running independent AnyThread modules concurrently on the thread pool
+		void UpdateModules(double dt);
+		// Runs the OnUpdate of an AnyThread node and records it as finished, on a worker or the main thread
+		void RunAnyThreadUpdate(uint32_t index);
 		void MainLoop();
 		void UnloadModules();
 	public:
 		Core();
 		// Runs the engine with the specified configuration file
 		void Run(const std::filesystem::path& configPath);
+		// Returns the "settings" object of the config file
+		const Settings& GetSettings() const;
 		// Returns the entity registry
 		EntityRegistry& GetEntityRegistry();
+		// Returns the worker pool shared by the engine
+		ThreadPool& GetThreadPool();
+		// Returns the asynchronous file and resource loader
+		ResourceService& GetResourceService();
+		// Returns the scheduler that runs coroutine tasks on the main thread
+		CoroutineScheduler& GetScheduler();
+		// Returns the manager of the independent worlds stepped in parallel alongside the main registry
+		WorldManager& GetWorldManager();
 		// Requests a shutdown and begins the shutdown sequence
 		void RequestShutdown();
 		// Returns whether a module is loaded, given its name
 		bool IsModuleLoaded(const std::string& moduleName);
 		// Returns a module by name
 		Module* GetModule(const std::string& moduleName);
+		// Services are registered in OnLoad and unregistered in OnUnload, while no module is updating. Resolve and
+		// GetServiceHandle only read, so they are safe from any module at any time, including AnyThread OnUpdate
+
+		// Makes service available to other modules as interface T, replacing any previous provider. Call from OnLoad only
+		template<typename T>
+		void RegisterService(T* service)
+		{
+			m_services[AllocateServiceSlot(entt::type_hash<T>::value())] = service;
+		}
+		// Removes the provider of interface T, existing handles will return nullptr. Call from OnUnload only
+		template<typename T>
+		void UnregisterService()
+		{
+			if (void** slot = FindServiceSlot(entt::type_hash<T>::value()))
+				*slot = nullptr;
+		}
+		// Returns the provider of interface T, or nullptr if there is none. Hashes the type, so prefer caching a handle in hot paths
+		template<typename T>
+		T* Resolve()
+		{
+			void** slot = FindServiceSlot(entt::type_hash<T>::value());
+			return slot ? static_cast<T*>(*slot) : nullptr;
+		}
+		// Returns a handle that resolves interface T with a single load, or an empty handle if T was never registered.
+		// Take it after the provider's OnLoad, which dependencies guarantee when taken in the dependent's OnLoad
+		template<typename T>
+		ServiceHandle<T> GetServiceHandle()
+		{
+			void** slot = FindServiceSlot(entt::type_hash<T>::value());
+			return slot ? ServiceHandle<T>(slot) : ServiceHandle<T>();
+		}
 		// Returns the singleton instance of the Core
 		static Core* Get();
 	};
@@ -0,0 +1,150 @@
+#include "CoroutineScheduler.hpp"
+#include <thread>
+#include <algorithm>
+
+namespace CrescendoEngine
+{
+	CoroutineEvent::~CoroutineEvent()
+	{
+		// Waiters can no longer be woken, but stay owned by their scheduler
+		std::scoped_lock lock(m_mutex);
+		for (auto handle : m_waiters)
+			handle.promise().awaitedEvent = nullptr;
+	}
+	void CoroutineEvent::Signal()
+	{
+		std::scoped_lock lock(m_mutex);
+		for (auto handle : m_waiters)
+		{
+			handle.promise().awaitedEvent = nullptr;
+			handle.promise().scheduler->Wake(handle);
+		}
+		m_waiters.clear();
+	}
+	size_t CoroutineEvent::GetWaiterCount() const
+	{
+		std::scoped_lock lock(m_mutex);
+		return m_waiters.size();
+	}
+	void CoroutineEvent::await_suspend(std::coroutine_handle<TaskPromise> handle)
+	{
+		std::scoped_lock lock(m_mutex);
+		handle.promise().awaitedEvent = this;
+		m_waiters.push_back(handle);
+	}
+
+	void CoroutineScheduler::OnTaskFinished(std::coroutine_handle<TaskPromise> handle)
+	{
+		TaskPromise& promise = handle.promise();
+		if (promise.exception && !m_exception)
+			m_exception = promise.exception;
+
+		if (promise.previous)
+			promise.previous->next = promise.next;
+		else
+			m_live = promise.next;
+		if (promise.next)
+			promise.next->previous = promise.previous;
+		m_liveCount--;
+		handle.destroy();
+	}
+	void CoroutineScheduler::OnJobFinished(std::coroutine_handle<TaskPromise> handle)
+	{
+		std::scoped_lock lock(m_incomingMutex);
+		m_woken.push_back(handle);
+		m_runningJobs--;
+	}
+	void CoroutineScheduler::Wake(std::coroutine_handle<TaskPromise> handle)
+	{
+		std::scoped_lock lock(m_incomingMutex);
+		m_woken.push_back(handle);
+	}
+	CoroutineScheduler::CoroutineScheduler(ThreadPool& threadPool) : m_threadPool(threadPool) {}
+	CoroutineScheduler::~CoroutineScheduler()
+	{
+		CancelAll();
+	}
+	void CoroutineScheduler::Spawn(Task task)
+	{
+		std::coroutine_handle<TaskPromise> handle = task.Release();
+		handle.promise().scheduler = this;
+		std::scoped_lock lock(m_incomingMutex);
+		m_spawned.push_back(handle);
+	}
+	void CoroutineScheduler::Update(double dt)
+	{
+		m_time += dt;
+
+		// Everything due this tick is gathered first, so tasks suspending again wait for the next update
+		m_resuming.swap(m_ready);
+		while (!m_timers.empty() && m_timers.top().wakeTime <= m_time)
+		{
+			m_resuming.push_back(m_timers.top().handle);
+			m_timers.pop();
+		}
+		{
+			std::scoped_lock lock(m_incomingMutex);
+			m_resuming.insert(m_resuming.end(), m_woken.begin(), m_woken.end());
+			m_woken.clear();
+			// New tasks join the live list here, so it is only ever touched by the main thread
+			for (auto handle : m_spawned)
+			{
+				TaskPromise& promise = handle.promise();
+				promise.previous = nullptr;
+				promise.next = m_live;
+				if (m_live)
+					m_live->previous = &promise;
+				m_live = &promise;
+				m_liveCount++;
+			}
+			m_resuming.insert(m_resuming.end(), m_spawned.begin(), m_spawned.end());
+			m_spawned.clear();
+		}
+
+		// Finishing tasks destroy their own frame during resume
+		for (auto handle : m_resuming)
+			handle.resume();
+		m_resuming.clear();
+
+		if (m_exception)
+			std::rethrow_exception(std::exchange(m_exception, nullptr));
+	}
+	void CoroutineScheduler::CancelAll()
+	{
+		// Jobs reference their awaiting frame, let them finish before destroying anything
+		while (m_runningJobs.load() > 0)
+			std::this_thread::yield();
+		{
+			// The last job decrements the count while still holding the lock, wait for it to let go
+			std::scoped_lock lock(m_incomingMutex);
+			m_woken.clear();
+			// Never started, so not in the live list
+			for (auto handle : m_spawned)
+				handle.destroy();
+			m_spawned.clear();
+		}
+
+		m_ready.clear();
+		m_timers = {};
+		while (m_live)
+		{
+			TaskPromise* promise = m_live;
+			m_live = promise->next;
+			if (promise->awaitedEvent)
+			{
+				std::scoped_lock lock(promise->awaitedEvent->m_mutex);
+				std::erase(promise->awaitedEvent->m_waiters, std::coroutine_handle<TaskPromise>::from_promise(*promise));
+			}
+			std::coroutine_handle<TaskPromise>::from_promise(*promise).destroy();
+		}
+		m_liveCount = 0;
+	}
+	size_t CoroutineScheduler::GetTaskCount() const
+	{
+		return m_liveCount;
+	}
+	double CoroutineScheduler::GetTime() const
+	{
+		return m_time;
+	}
+}
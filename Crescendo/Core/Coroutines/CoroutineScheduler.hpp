@@ -0,0 +1,188 @@
+#pragma once
+#include <mutex>
+#include <queue>
+#include <atomic>
+#include <vector>
+#include <optional>
+#include <variant>
+#include <functional>
+#include <type_traits>
+#include "Task.hpp"
+#include "OSDetection.hpp"
+#include "Threading/ThreadPool.hpp"
+
+namespace CrescendoEngine
+{
+	// Wakes every task currently awaiting it when signalled. Signal may be called from any thread, tasks resume on the main thread
+	class CS_CORE_EXPORT CoroutineEvent
+	{
+	private:
+		friend class CoroutineScheduler;
+		mutable std::mutex m_mutex;
+		std::vector<std::coroutine_handle<TaskPromise>> m_waiters;
+	public:
+		CoroutineEvent() = default;
+		~CoroutineEvent();
+		CoroutineEvent(const CoroutineEvent&) = delete;
+		CoroutineEvent& operator=(const CoroutineEvent&) = delete;
+
+		// Schedules every waiting task to resume on the next scheduler update
+		void Signal();
+		// Returns the number of tasks waiting on this event
+		size_t GetWaiterCount() const;
+
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(std::coroutine_handle<TaskPromise> handle);
+		void await_resume() const noexcept {}
+	};
+
+	// Runs Tasks on the main thread. Tasks are resumed from Update, which Core calls once per tick after the modules.
+	// Spawn and CoroutineEvent::Signal are safe from any thread, including AnyThread module updates. Everything else,
+	// and the task bodies themselves, only ever runs on the main thread
+	class CS_CORE_EXPORT CoroutineScheduler
+	{
+	private:
+		friend struct TaskPromise::FinalAwaiter;
+		friend class CoroutineEvent;
+		struct Timer
+		{
+			double wakeTime;
+			uint64_t sequence;
+			std::coroutine_handle<TaskPromise> handle;
+
+			bool operator>(const Timer& other) const
+			{
+				return wakeTime != other.wakeTime ? wakeTime > other.wakeTime : sequence > other.sequence;
+			}
+		};
+	private:
+		ThreadPool& m_threadPool;
+		double m_time = 0.0;
+		uint64_t m_timerSequence = 0;
+		// Tasks to resume on the next update, and the batch being resumed by the current one
+		std::vector<std::coroutine_handle<TaskPromise>> m_ready;
+		std::vector<std::coroutine_handle<TaskPromise>> m_resuming;
+		std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> m_timers;
+		// Filled from any thread, drained by Update. Tasks spawned since the last update, and tasks whose job
+		// finished or whose event was signalled
+		std::mutex m_incomingMutex;
+		std::vector<std::coroutine_handle<TaskPromise>> m_spawned;
+		std::vector<std::coroutine_handle<TaskPromise>> m_woken;
+		std::atomic<size_t> m_runningJobs = 0;
+		// Intrusive list of every spawned task that has not finished
+		TaskPromise* m_live = nullptr;
+		size_t m_liveCount = 0;
+		std::exception_ptr m_exception;
+	private:
+		void OnTaskFinished(std::coroutine_handle<TaskPromise> handle);
+		void OnJobFinished(std::coroutine_handle<TaskPromise> handle);
+		// Queues a suspended task to resume on the next update, from any thread
+		void Wake(std::coroutine_handle<TaskPromise> handle);
+	public:
+		explicit CoroutineScheduler(ThreadPool& threadPool);
+		~CoroutineScheduler();
+		CoroutineScheduler(const CoroutineScheduler&) = delete;
+		CoroutineScheduler& operator=(const CoroutineScheduler&) = delete;
+
+		// Takes ownership of the task, which starts running on the next update. Safe from any thread
+		void Spawn(Task task);
+		// Advances the clock by dt and resumes every task that is due. Rethrows the first exception that escaped a task
+		void Update(double dt);
+		// Destroys every unfinished task, waiting for their jobs first. Called by Core before modules are unloaded,
+		// nothing may spawn or signal concurrently
+		void CancelAll();
+		// Returns the number of started tasks that have not finished, tasks spawned since the last update are not counted
+		size_t GetTaskCount() const;
+		// Returns the time accumulated by Update, in seconds
+		double GetTime() const;
+
+		// Awaitable resuming the task on the next update
+		struct NextTickAwaiter
+		{
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(std::coroutine_handle<TaskPromise> handle) const
+			{
+				handle.promise().scheduler->m_ready.push_back(handle);
+			}
+			void await_resume() const noexcept {}
+		};
+		// Awaitable resuming the task on the first update at least seconds from now
+		struct DelayAwaiter
+		{
+			double seconds;
+
+			bool await_ready() const noexcept { return seconds <= 0.0; }
+			void await_suspend(std::coroutine_handle<TaskPromise> handle) const
+			{
+				CoroutineScheduler& scheduler = *handle.promise().scheduler;
+				scheduler.m_timers.push({ scheduler.m_time + seconds, scheduler.m_timerSequence++, handle });
+			}
+			void await_resume() const noexcept {}
+		};
+		// Awaitable running func on the thread pool and resuming the task with its result on the update after it finishes
+		template<typename Func>
+		struct JobAwaiter
+		{
+			using Result = std::invoke_result_t<Func>;
+			using Storage = std::conditional_t<std::is_void_v<Result>, std::monostate, Result>;
+
+			Func func;
+			std::optional<Storage> result;
+			std::exception_ptr exception;
+
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(std::coroutine_handle<TaskPromise> handle)
+			{
+				CoroutineScheduler* scheduler = handle.promise().scheduler;
+				scheduler->m_runningJobs++;
+				// The awaiter lives in the suspended frame, so it outlives the job
+				scheduler->m_threadPool.Submit([this, handle, scheduler] {
+					try
+					{
+						if constexpr (std::is_void_v<Result>)
+						{
+							func();
+							result.emplace();
+						}
+						else
+							result.emplace(func());
+					}
+					catch (...)
+					{
+						exception = std::current_exception();
+					}
+					scheduler->OnJobFinished(handle);
+				});
+			}
+			Result await_resume()
+			{
+				if (exception)
+					std::rethrow_exception(exception);
+				if constexpr (!std::is_void_v<Result>)
+					return std::move(*result);
+			}
+		};
+	};
+
+	// co_await NextTick(), suspends until the next tick
+	inline CoroutineScheduler::NextTickAwaiter NextTick()
+	{
+		return {};
+	}
+	// co_await WaitSeconds(s), suspends for at least s seconds of simulated time
+	inline CoroutineScheduler::DelayAwaiter WaitSeconds(double seconds)
+	{
+		return { seconds };
+	}
+	// auto result = co_await RunJob(func), runs func on the thread pool without blocking the tick
+	template<typename Func>
+	CoroutineScheduler::JobAwaiter<std::decay_t<Func>> RunJob(Func&& func)
+	{
+		return { std::forward<Func>(func) };
+	}
+
+	inline void TaskPromise::FinalAwaiter::await_suspend(std::coroutine_handle<TaskPromise> handle) noexcept
+	{
+		handle.promise().scheduler->OnTaskFinished(handle);
+	}
+}
@@ -0,0 +1,86 @@
+#include "FramePool.hpp"
+#include <mutex>
+#include <array>
+#include <vector>
+#include <memory>
+
+namespace CrescendoEngine::FramePool
+{
+	namespace
+	{
+		constexpr size_t MIN_CLASS_SIZE = 64;
+		constexpr size_t CLASS_COUNT = 7; // 64, 128, ..., 4096
+		constexpr size_t BLOCKS_PER_CHUNK = 64;
+
+		struct FreeBlock
+		{
+			FreeBlock* next;
+		};
+		struct SizeClass
+		{
+			std::mutex mutex;
+			FreeBlock* freeList = nullptr;
+			// Blocks are carved out of chunks which live until shutdown
+			std::vector<std::unique_ptr<std::byte[]>> chunks;
+		};
+		std::array<SizeClass, CLASS_COUNT> s_classes;
+
+		size_t ClassIndex(size_t size)
+		{
+			size_t index = 0;
+			for (size_t classSize = MIN_CLASS_SIZE; classSize < size; classSize <<= 1)
+				index++;
+			return index;
+		}
+		// Carves a new chunk of blockCount blocks onto the free list, the class mutex must be held
+		void AddChunk(SizeClass& sizeClass, size_t index, size_t blockCount)
+		{
+			const size_t blockSize = MIN_CLASS_SIZE << index;
+			std::byte* chunk = sizeClass.chunks.emplace_back(new std::byte[blockSize * blockCount]).get();
+			for (size_t i = blockCount; i-- > 0;)
+			{
+				FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + i * blockSize);
+				block->next = sizeClass.freeList;
+				sizeClass.freeList = block;
+			}
+		}
+	}
+
+	void* Allocate(size_t size)
+	{
+		if (size > MAX_POOLED_SIZE)
+			return ::operator new(size);
+
+		const size_t index = ClassIndex(size);
+		SizeClass& sizeClass = s_classes[index];
+		std::scoped_lock lock(sizeClass.mutex);
+		if (sizeClass.freeList == nullptr)
+			AddChunk(sizeClass, index, BLOCKS_PER_CHUNK);
+		FreeBlock* block = sizeClass.freeList;
+		sizeClass.freeList = block->next;
+		return block;
+	}
+	void Deallocate(void* pointer, size_t size)
+	{
+		if (size > MAX_POOLED_SIZE)
+		{
+			::operator delete(pointer);
+			return;
+		}
+
+		SizeClass& sizeClass = s_classes[ClassIndex(size)];
+		std::scoped_lock lock(sizeClass.mutex);
+		FreeBlock* block = static_cast<FreeBlock*>(pointer);
+		block->next = sizeClass.freeList;
+		sizeClass.freeList = block;
+	}
+	void Reserve(size_t frameSize, size_t count)
+	{
+		if (frameSize > MAX_POOLED_SIZE || count == 0)
+			return;
+		const size_t index = ClassIndex(frameSize);
+		SizeClass& sizeClass = s_classes[index];
+		std::scoped_lock lock(sizeClass.mutex);
+		AddChunk(sizeClass, index, count);
+	}
+}
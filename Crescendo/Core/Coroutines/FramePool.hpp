@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+#include "OSDetection.hpp"
+
+namespace CrescendoEngine
+{
+	// Size class allocator for coroutine frames. Freed blocks are kept for reuse, so spawning and finishing
+	// thousands of short tasks per tick does not touch the global heap once warmed up. Thread-safe
+	namespace FramePool
+	{
+		// Largest frame served from the pool, bigger frames fall back to operator new
+		constexpr size_t MAX_POOLED_SIZE = 4096;
+
+		CS_CORE_EXPORT void* Allocate(size_t size);
+		CS_CORE_EXPORT void Deallocate(void* pointer, size_t size);
+		// Preallocates count free blocks able to hold frames of frameSize bytes
+		CS_CORE_EXPORT void Reserve(size_t frameSize, size_t count);
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <utility>
+#include <coroutine>
+#include <exception>
+#include "FramePool.hpp"
+
+namespace CrescendoEngine
+{
+	class CoroutineScheduler;
+	class CoroutineEvent;
+
+	// Promise of Task, also the intrusive node the scheduler uses to track live tasks
+	struct TaskPromise
+	{
+		CoroutineScheduler* scheduler = nullptr;
+		TaskPromise* previous = nullptr;
+		TaskPromise* next = nullptr;
+		// Event the task is suspended on, if any, so it can be unregistered when destroyed early
+		CoroutineEvent* awaitedEvent = nullptr;
+		std::exception_ptr exception;
+
+		struct FinalAwaiter
+		{
+			bool await_ready() const noexcept { return false; }
+			// Defined in CoroutineScheduler.hpp, hands the finished task back to its scheduler
+			void await_suspend(std::coroutine_handle<TaskPromise> handle) noexcept;
+			void await_resume() const noexcept {}
+		};
+
+		static void* operator new(size_t size) { return FramePool::Allocate(size); }
+		static void operator delete(void* pointer, size_t size) { FramePool::Deallocate(pointer, size); }
+
+		std::coroutine_handle<TaskPromise> get_return_object() { return std::coroutine_handle<TaskPromise>::from_promise(*this); }
+		// Tasks do not run until they are spawned on a scheduler
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		FinalAwaiter final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { exception = std::current_exception(); }
+	};
+
+	// Coroutine spanning any number of ticks, see CoroutineScheduler for the awaitables it can use.
+	// Owns the coroutine until it is given to CoroutineScheduler::Spawn
+	class Task
+	{
+	public:
+		using promise_type = TaskPromise;
+	private:
+		std::coroutine_handle<TaskPromise> m_handle;
+	public:
+		Task(std::coroutine_handle<TaskPromise> handle) : m_handle(handle) {}
+		Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+		Task& operator=(Task&& other) noexcept
+		{
+			if (this != &other)
+			{
+				if (m_handle)
+					m_handle.destroy();
+				m_handle = std::exchange(other.m_handle, nullptr);
+			}
+			return *this;
+		}
+		Task(const Task&) = delete;
+		Task& operator=(const Task&) = delete;
+		~Task()
+		{
+			if (m_handle)
+				m_handle.destroy();
+		}
+
+		// Gives up ownership of the coroutine
+		std::coroutine_handle<TaskPromise> Release()
+		{
+			return std::exchange(m_handle, nullptr);
+		}
+	};
+}
@@ -65,6 +65,12 @@ namespace CrescendoEngine
 			T& component = m_Registry->emplace<T>(this->m_Entity, std::forward<Args>(args)...);
 			return component;
 		};
+		// Modifies a component in place through func and notifies update listeners, such as spatial indices
+		template<ValidComponent T, typename Func>
+		T& PatchComponent(Func&& func)
+		{
+			return m_Registry->patch<T>(this->m_Entity, std::forward<Func>(func));
+		}
 		// Removes a component from the m_Entity
 		template<ValidComponent T>
 		void RemoveComponent()
@@ -1,7 +1,18 @@
 #pragma once
+#include <memory>
+#include <map>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <unordered_map>
 #include "entt/entt.hpp"
 #include "Component.hpp"
 #include "Entity.hpp"
+#include "SoAStorage.hpp"
+#include "TransformHierarchy.hpp"
+#include "Position.hpp"
+#include "Spatial/SpatialIndex.hpp"
+#include "OSDetection.hpp"
 
 namespace CrescendoEngine
 {
@@ -9,6 +20,11 @@ namespace CrescendoEngine
 	{
 	private:
 		entt::registry m_Registry;
+		// Opt-in structure-of-arrays storages, keyed by component type hash
+		std::unordered_map<entt::id_type, std::unique_ptr<SoAStorageBase>> m_SoAStorages;
+		TransformHierarchy m_Hierarchy;
+		// Reserves storage for a component type by its registered name, used by the capacity settings
+		std::map<std::string, std::function<void(size_t)>, std::less<>> m_ComponentReservers;
 	public:
 		EntityRegistry() = default;
 		~EntityRegistry() = default;
@@ -20,6 +36,9 @@ namespace CrescendoEngine
 		// Destroys the entity and all of its components.
 		void DestroyEntity(Entity entity)
 		{
+			for (auto& [id, storage] : m_SoAStorages)
+				storage->Remove(entity);
+			m_Hierarchy.Remove(entity);
 			m_Registry.destroy(entity);
 		}
 		// DEEP clones the entity and all of its components.
@@ -31,14 +50,103 @@ namespace CrescendoEngine
 				if (storage.contains(entity))
 					storage.push(other, storage.value(entity));
 			}
+			for (auto& [id, storage] : m_SoAStorages)
+				storage->Copy(entity, other);
+			// The copy joins the hierarchy as a sibling of the original, children are not copied
+			if (m_Hierarchy.Contains(entity))
+			{
+				const Transform local = m_Hierarchy.GetLocal(entity);
+				m_Hierarchy.Add(other, local, m_Hierarchy.GetParent(entity));
+			}
 			return other;
 		}
+		// Destroys every entity, component pool, SoA storage and registered component name. Pools and reservers are
+		// instantiated in module code, so Core calls this after OnUnload and before the module libraries are freed
+		void Clear()
+		{
+			m_ComponentReservers.clear();
+			m_SoAStorages.clear();
+			m_Registry = entt::registry();
+			m_Hierarchy = TransformHierarchy();
+		}
 		// Returns the number of components of type T in the registry.
 		template <ValidComponent T>
 		size_t GetComponentCount() const
 		{
 			return m_Registry.view<T>().size();
 		}
+		// Preallocates room for count entities
+		void ReserveEntities(size_t count)
+		{
+			m_Registry.storage<entt::entity>().reserve(count);
+		}
+		// Makes T reservable by name through ReserveComponents, structure-of-arrays components reserve their SoAStorage
+		template<typename T>
+		void RegisterComponentName(std::string name)
+		{
+			if constexpr (SoAComponent<T>)
+				m_ComponentReservers[std::move(name)] = [this](size_t count) { GetSoAStorage<T>().Reserve(count); };
+			else
+				m_ComponentReservers[std::move(name)] = [this](size_t count) { m_Registry.storage<T>().reserve(count); };
+		}
+		// Preallocates room for count components of the type registered under name, returns false if no type has that name
+		bool ReserveComponents(std::string_view name, size_t count)
+		{
+			auto it = m_ComponentReservers.find(name);
+			if (it == m_ComponentReservers.end())
+				return false;
+			it->second(count);
+			return true;
+		}
+		// Returns the parent/child hierarchy, world matrices are refreshed by Core after every update
+		TransformHierarchy& GetTransformHierarchy()
+		{
+			return m_Hierarchy;
+		}
+		// Keeps the index in sync with every Position component. Positions must then be changed through
+		// AddComponent, EmplaceComponent or PatchComponent so that the index is notified
+		void TrackPositions(SpatialIndex& index)
+		{
+			m_Registry.on_construct<Position>().connect<&SpatialIndex::OnPositionChanged>(index);
+			m_Registry.on_update<Position>().connect<&SpatialIndex::OnPositionChanged>(index);
+			m_Registry.on_destroy<Position>().connect<&SpatialIndex::OnPositionRemoved>(index);
+			for (auto [entity, position] : m_Registry.view<Position>().each())
+				index.Update(entity, position.value);
+		}
+		// Stops keeping the index in sync, the index keeps its current contents
+		void UntrackPositions(SpatialIndex& index)
+		{
+			m_Registry.on_construct<Position>().disconnect(&index);
+			m_Registry.on_update<Position>().disconnect(&index);
+			m_Registry.on_destroy<Position>().disconnect(&index);
+		}
+		// Returns the structure-of-arrays storage for T, creating it on first use. The reference stays valid for the lifetime of the registry
+		template<SoAComponent T>
+		SoAStorage<T>& GetSoAStorage()
+		{
+			std::unique_ptr<SoAStorageBase>& storage = m_SoAStorages[entt::type_hash<T>::value()];
+			if (!storage)
+				storage = std::make_unique<SoAStorage<T>>();
+			return static_cast<SoAStorage<T>&>(*storage);
+		}
+		// Adds a component stored as structure-of-arrays to the entity
+		template<SoAComponent T>
+		void AddSoAComponent(Entity entity, const T& component)
+		{
+			GetSoAStorage<T>().Emplace(entity, component);
+		}
+		// Removes a structure-of-arrays component from the entity
+		template<SoAComponent T>
+		void RemoveSoAComponent(Entity entity)
+		{
+			GetSoAStorage<T>().Remove(entity);
+		}
+		// Runs func once with an aligned span per annotated field of T, suited to the kernels in SIMD/Kernels.hpp
+		template<SoAComponent T, typename Func>
+		void ForEachSoA(Func&& func)
+		{
+			GetSoAStorage<T>().ForEach(std::forward<Func>(func));
+		}
 		// Runs a loop over all entities with all the components in T...
 		template<ValidComponent ...T>
 		void ForEach(std::function<void(T&...)> func)
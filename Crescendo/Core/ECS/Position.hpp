@@ -0,0 +1,15 @@
+#pragma once
+#include <array>
+#include "Component.hpp"
+
+namespace CrescendoEngine
+{
+	// World space position of an entity, tracked by spatial indices
+	struct Position : public Component
+	{
+		std::array<float, 3> value = { 0.0f, 0.0f, 0.0f };
+
+		Position() = default;
+		Position(float x, float y, float z) : value{ x, y, z } {}
+	};
+}
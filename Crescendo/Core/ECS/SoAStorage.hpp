@@ -0,0 +1,209 @@
+#pragma once
+#include <array>
+#include <span>
+#include <tuple>
+#include <vector>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <cstring>
+#include <utility>
+#include "entt/entt.hpp"
+#include "Component.hpp"
+
+// Declares which fields of a component are stored as separate arrays, e.g. CS_SOA_FIELDS(&Velocity::x, &Velocity::y)
+#define CS_SOA_FIELDS(...) static constexpr auto soaFields = std::make_tuple(__VA_ARGS__);
+
+namespace CrescendoEngine
+{
+	namespace Internal
+	{
+		template<typename T, typename Tuple>
+		struct AreFloatFields : std::false_type {};
+		template<typename T, typename... Fields>
+		struct AreFloatFields<T, std::tuple<Fields...>> : std::bool_constant<(std::is_same_v<Fields, float T::*> && ...)> {};
+	}
+
+	// Components opting into structure-of-arrays storage, every annotated field must be a float member
+	template<typename T>
+	concept SoAComponent = ValidComponent<T> && std::is_default_constructible_v<T> &&
+		Internal::AreFloatFields<T, std::remove_cv_t<decltype(T::soaFields)>>::value;
+
+	// Type erased base so the registry can strip destroyed entities from every SoA storage
+	class SoAStorageBase
+	{
+	public:
+		virtual ~SoAStorageBase() {};
+		virtual bool Contains(entt::entity entity) const = 0;
+		virtual void Remove(entt::entity entity) = 0;
+		virtual void Copy(entt::entity from, entt::entity to) = 0;
+		virtual void Clear() = 0;
+		virtual void Reserve(size_t capacity) = 0;
+	};
+
+	// Stores each annotated field of T in its own 32-byte aligned array so bulk numeric updates can be vectorised.
+	// Removal swaps the last element into the hole, so dense indices are only stable until the next removal.
+	template<SoAComponent T>
+	class SoAStorage : public SoAStorageBase
+	{
+	public:
+		static constexpr size_t FIELD_COUNT = std::tuple_size_v<decltype(T::soaFields)>;
+		// Alignment of every field array, enough for AVX loads
+		static constexpr size_t ALIGNMENT = 32;
+	private:
+		static constexpr uint32_t NULL_INDEX = ~uint32_t(0);
+		static constexpr size_t GRANULARITY = ALIGNMENT / sizeof(float);
+
+		struct AlignedDeleter
+		{
+			void operator()(float* ptr) const { ::operator delete[](ptr, std::align_val_t(ALIGNMENT)); }
+		};
+		using FieldArray = std::unique_ptr<float[], AlignedDeleter>;
+	private:
+		std::array<FieldArray, FIELD_COUNT> m_Fields;
+		std::vector<entt::entity> m_Entities;
+		// Indexed by entity id, maps to the dense index
+		std::vector<uint32_t> m_Sparse;
+		size_t m_Capacity = 0;
+	private:
+		void Grow(size_t minimum)
+		{
+			size_t capacity = std::max<size_t>(m_Capacity * 2, GRANULARITY);
+			while (capacity < minimum)
+				capacity *= 2;
+			capacity = (capacity + GRANULARITY - 1) / GRANULARITY * GRANULARITY;
+			for (FieldArray& field : m_Fields)
+			{
+				FieldArray grown(new (std::align_val_t(ALIGNMENT)) float[capacity]);
+				if (field)
+					std::memcpy(grown.get(), field.get(), m_Entities.size() * sizeof(float));
+				field = std::move(grown);
+			}
+			m_Capacity = capacity;
+		}
+		template<size_t... I>
+		void Store(size_t index, const T& component, std::index_sequence<I...>)
+		{
+			((m_Fields[I][index] = component.*std::get<I>(T::soaFields)), ...);
+		}
+		template<size_t... I>
+		void Load(size_t index, T& component, std::index_sequence<I...>) const
+		{
+			((component.*std::get<I>(T::soaFields) = m_Fields[I][index]), ...);
+		}
+		template<typename Func, size_t... I>
+		void Apply(Func&& func, std::index_sequence<I...>)
+		{
+			func(Field<I>()...);
+		}
+		static size_t ToIndex(entt::entity entity)
+		{
+			return static_cast<size_t>(entt::to_entity(entity));
+		}
+		uint32_t DenseIndex(entt::entity entity) const
+		{
+			const size_t id = ToIndex(entity);
+			if (id >= m_Sparse.size())
+				return NULL_INDEX;
+			const uint32_t index = m_Sparse[id];
+			return (index != NULL_INDEX && m_Entities[index] == entity) ? index : NULL_INDEX;
+		}
+	public:
+		SoAStorage() = default;
+		SoAStorage(const SoAStorage&) = delete;
+		SoAStorage& operator=(const SoAStorage&) = delete;
+
+		// Inserts or overwrites the component for an entity
+		void Emplace(entt::entity entity, const T& component)
+		{
+			uint32_t index = DenseIndex(entity);
+			if (index == NULL_INDEX)
+			{
+				if (m_Entities.size() == m_Capacity)
+					Grow(m_Entities.size() + 1);
+				const size_t id = ToIndex(entity);
+				if (id >= m_Sparse.size())
+					m_Sparse.resize(id + 1, NULL_INDEX);
+				index = static_cast<uint32_t>(m_Entities.size());
+				m_Sparse[id] = index;
+				m_Entities.push_back(entity);
+			}
+			Store(index, component, std::make_index_sequence<FIELD_COUNT>{});
+		}
+		// Returns true if the entity has a component in this storage
+		bool Contains(entt::entity entity) const override
+		{
+			return DenseIndex(entity) != NULL_INDEX;
+		}
+		// Removes the component of an entity, does nothing if it has none
+		void Remove(entt::entity entity) override
+		{
+			const uint32_t index = DenseIndex(entity);
+			if (index == NULL_INDEX)
+				return;
+			const size_t last = m_Entities.size() - 1;
+			if (index != last)
+			{
+				for (FieldArray& field : m_Fields)
+					field[index] = field[last];
+				m_Entities[index] = m_Entities[last];
+				m_Sparse[ToIndex(m_Entities[index])] = index;
+			}
+			m_Sparse[ToIndex(entity)] = NULL_INDEX;
+			m_Entities.pop_back();
+		}
+		// Copies the component of one entity onto another, does nothing if the source has none
+		void Copy(entt::entity from, entt::entity to) override
+		{
+			if (Contains(from))
+				Emplace(to, Get(from));
+		}
+		// Removes every component, keeps the allocated memory
+		void Clear() override
+		{
+			m_Entities.clear();
+			m_Sparse.clear();
+		}
+		// Preallocates room for at least capacity components
+		void Reserve(size_t capacity) override
+		{
+			if (capacity > m_Capacity)
+				Grow(capacity);
+		}
+		// Gathers the fields of an entity into a component, throws if the entity has none
+		T Get(entt::entity entity) const
+		{
+			const uint32_t index = DenseIndex(entity);
+			if (index == NULL_INDEX)
+				throw std::out_of_range("Entity does not have this SoA component");
+			T component{};
+			Load(index, component, std::make_index_sequence<FIELD_COUNT>{});
+			return component;
+		}
+		// Returns the number of components stored
+		size_t Size() const
+		{
+			return m_Entities.size();
+		}
+		// Entities in dense order, index i owns element i of every field span
+		std::span<const entt::entity> Entities() const
+		{
+			return m_Entities;
+		}
+		// Returns the aligned array of the I-th annotated field
+		template<size_t I>
+		std::span<float> Field()
+		{
+			static_assert(I < FIELD_COUNT, "Field index out of range");
+			return { m_Fields[I].get(), m_Entities.size() };
+		}
+		// Calls func once with a span per annotated field, in declaration order
+		template<typename Func>
+		void ForEach(Func&& func)
+		{
+			if (m_Entities.empty())
+				return;
+			Apply(std::forward<Func>(func), std::make_index_sequence<FIELD_COUNT>{});
+		}
+	};
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <array>
+#include "Component.hpp"
+
+namespace CrescendoEngine
+{
+	// Column-major 4x4 matrix
+	struct Matrix4
+	{
+		std::array<float, 16> m = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+
+		// Returns this * other
+		Matrix4 operator*(const Matrix4& other) const
+		{
+			Matrix4 result;
+			for (size_t column = 0; column < 4; column++)
+			{
+				for (size_t row = 0; row < 4; row++)
+				{
+					result.m[column * 4 + row] =
+						m[0 * 4 + row] * other.m[column * 4 + 0] +
+						m[1 * 4 + row] * other.m[column * 4 + 1] +
+						m[2 * 4 + row] * other.m[column * 4 + 2] +
+						m[3 * 4 + row] * other.m[column * 4 + 3];
+				}
+			}
+			return result;
+		}
+	};
+
+	// Local translation, rotation and scale of an entity relative to its parent
+	struct Transform : public Component
+	{
+		std::array<float, 3> position = { 0.0f, 0.0f, 0.0f };
+		// Unit quaternion, stored as x, y, z, w
+		std::array<float, 4> rotation = { 0.0f, 0.0f, 0.0f, 1.0f };
+		std::array<float, 3> scale = { 1.0f, 1.0f, 1.0f };
+
+		// Returns the matrix that applies scale, then rotation, then translation
+		Matrix4 ToMatrix() const
+		{
+			const float x = rotation[0], y = rotation[1], z = rotation[2], w = rotation[3];
+			Matrix4 result;
+			result.m[0] = (1.0f - 2.0f * (y * y + z * z)) * scale[0];
+			result.m[1] = (2.0f * (x * y + z * w)) * scale[0];
+			result.m[2] = (2.0f * (x * z - y * w)) * scale[0];
+			result.m[4] = (2.0f * (x * y - z * w)) * scale[1];
+			result.m[5] = (1.0f - 2.0f * (x * x + z * z)) * scale[1];
+			result.m[6] = (2.0f * (y * z + x * w)) * scale[1];
+			result.m[8] = (2.0f * (x * z + y * w)) * scale[2];
+			result.m[9] = (2.0f * (y * z - x * w)) * scale[2];
+			result.m[10] = (1.0f - 2.0f * (x * x + y * y)) * scale[2];
+			result.m[12] = position[0];
+			result.m[13] = position[1];
+			result.m[14] = position[2];
+			return result;
+		}
+	};
+}
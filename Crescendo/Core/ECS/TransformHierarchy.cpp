@@ -0,0 +1,378 @@
+#include "TransformHierarchy.hpp"
+#include "Console.hpp"
+#include "Threading/ThreadPool.hpp"
+#include <algorithm>
+
+namespace CrescendoEngine
+{
+	uint32_t TransformHierarchy::GetSlot(entt::entity entity) const
+	{
+		if (entity == entt::null)
+			return NULL_INDEX;
+		const size_t id = static_cast<size_t>(entt::to_entity(entity));
+		if (id >= m_sparse.size())
+			return NULL_INDEX;
+		const uint32_t slot = m_sparse[id];
+		return (slot != NULL_INDEX && m_entities[slot] == entity) ? slot : NULL_INDEX;
+	}
+	uint32_t TransformHierarchy::GetExistingSlot(entt::entity entity) const
+	{
+		const uint32_t slot = GetSlot(entity);
+		if (slot == NULL_INDEX)
+			Console::Fatal<std::out_of_range>("Entity ", entt::to_integral(entity), " is not part of the transform hierarchy");
+		return slot;
+	}
+	void TransformHierarchy::MarkDirty(uint32_t slot)
+	{
+		const uint32_t index = m_orderIndices[slot];
+		if (m_dirty[index] != CLEAN)
+			return;
+		m_dirty[index] = PENDING;
+		m_dirtyLevels[m_depths[slot]].push_back(index);
+	}
+	void TransformHierarchy::SetDepth(uint32_t slot, uint32_t depth)
+	{
+		if (depth >= m_depthCounts.size())
+		{
+			m_depthCounts.resize(depth + 1);
+			m_dirtyLevels.resize(depth + 1);
+		}
+		m_depthCounts[depth]++;
+		m_depths[slot] = depth;
+	}
+	void TransformHierarchy::Link(uint32_t slot, uint32_t parent)
+	{
+		m_parents[slot] = parent;
+		m_previousSiblings[slot] = NULL_INDEX;
+		m_nextSiblings[slot] = NULL_INDEX;
+		if (parent == NULL_INDEX)
+			return;
+		const uint32_t first = m_firstChildren[parent];
+		m_nextSiblings[slot] = first;
+		if (first != NULL_INDEX)
+			m_previousSiblings[first] = slot;
+		m_firstChildren[parent] = slot;
+	}
+	void TransformHierarchy::Unlink(uint32_t slot)
+	{
+		const uint32_t parent = m_parents[slot];
+		if (parent == NULL_INDEX)
+			return;
+		const uint32_t previous = m_previousSiblings[slot];
+		const uint32_t next = m_nextSiblings[slot];
+		if (previous != NULL_INDEX)
+			m_nextSiblings[previous] = next;
+		else
+			m_firstChildren[parent] = next;
+		if (next != NULL_INDEX)
+			m_previousSiblings[next] = previous;
+		m_parents[slot] = NULL_INDEX;
+	}
+	size_t TransformHierarchy::UpdateSubtreeDepths(uint32_t slot, uint32_t depth)
+	{
+		if (m_depths[slot] == depth)
+			return 0;
+		size_t moved = 0;
+		m_stack.clear();
+		m_stack.push_back(slot);
+		while (!m_stack.empty())
+		{
+			const uint32_t current = m_stack.back();
+			m_stack.pop_back();
+			moved++;
+
+			const uint32_t parent = m_parents[current];
+			m_depthCounts[m_depths[current]]--;
+			SetDepth(current, (current == slot) ? depth : m_depths[parent] + 1);
+			// The old dirty entry is now stale, queue it again at the right depth
+			const uint32_t index = m_orderIndices[current];
+			if (m_dirty[index] == PENDING)
+				m_dirtyLevels[m_depths[current]].push_back(index);
+
+			for (uint32_t child = m_firstChildren[current]; child != NULL_INDEX; child = m_nextSiblings[child])
+				m_stack.push_back(child);
+		}
+		return moved;
+	}
+	void TransformHierarchy::ScatterChildren(uint32_t index)
+	{
+		m_childCounts[index] = NULL_INDEX;
+	}
+	void TransformHierarchy::Compact()
+	{
+		const size_t count = Size();
+		m_sortedOrder.clear();
+		m_sortedLocals.clear();
+		m_sortedWorlds.clear();
+		m_sortedDirty.clear();
+		m_sortedOrder.reserve(count);
+		m_sortedLocals.reserve(count);
+		m_sortedWorlds.reserve(count);
+		m_sortedDirty.reserve(count);
+		m_orderParents.resize(count);
+		m_firstChildIndices.resize(count);
+		m_childCounts.resize(count);
+
+		auto append = [this](uint32_t slot, uint32_t parentIndex) {
+			const uint32_t index = m_orderIndices[slot];
+			m_orderParents[m_sortedOrder.size()] = parentIndex;
+			m_sortedOrder.push_back(slot);
+			m_sortedLocals.push_back(m_locals[index]);
+			m_sortedWorlds.push_back(m_worlds[index]);
+			m_sortedDirty.push_back(m_dirty[index]);
+		};
+		// Roots keep their relative order, every other level is the concatenation of the children of the level above
+		for (uint32_t slot : m_order)
+		{
+			if (slot != NULL_INDEX && m_parents[slot] == NULL_INDEX)
+				append(slot, NULL_INDEX);
+		}
+		for (uint32_t index = 0; index < m_sortedOrder.size(); index++)
+		{
+			m_firstChildIndices[index] = static_cast<uint32_t>(m_sortedOrder.size());
+			for (uint32_t child = m_firstChildren[m_sortedOrder[index]]; child != NULL_INDEX; child = m_nextSiblings[child])
+				append(child, index);
+			m_childCounts[index] = static_cast<uint32_t>(m_sortedOrder.size()) - m_firstChildIndices[index];
+		}
+
+		m_order.swap(m_sortedOrder);
+		m_locals.swap(m_sortedLocals);
+		m_worlds.swap(m_sortedWorlds);
+		m_dirty.swap(m_sortedDirty);
+
+		// Every queued position moved, queue the pending nodes again in their new order
+		for (std::vector<uint32_t>& dirty : m_dirtyLevels)
+			dirty.clear();
+		for (uint32_t index = 0; index < m_order.size(); index++)
+		{
+			m_orderIndices[m_order[index]] = index;
+			if (m_dirty[index] != CLEAN)
+				m_dirtyLevels[m_depths[m_order[index]]].push_back(index);
+		}
+		m_displacedCount = 0;
+	}
+	void TransformHierarchy::Add(entt::entity entity, const Transform& local, entt::entity parent)
+	{
+		if (GetSlot(entity) != NULL_INDEX)
+			Console::Fatal<std::invalid_argument>("Entity ", entt::to_integral(entity), " is already part of the transform hierarchy");
+		const uint32_t parentSlot = (parent == entt::null) ? NULL_INDEX : GetExistingSlot(parent);
+
+		uint32_t slot;
+		if (!m_freeSlots.empty())
+		{
+			slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else
+		{
+			slot = static_cast<uint32_t>(m_entities.size());
+			m_entities.emplace_back();
+			m_parents.emplace_back();
+			m_firstChildren.emplace_back();
+			m_nextSiblings.emplace_back();
+			m_previousSiblings.emplace_back();
+			m_depths.emplace_back();
+			m_orderIndices.emplace_back();
+		}
+
+		const size_t id = static_cast<size_t>(entt::to_entity(entity));
+		if (id >= m_sparse.size())
+			m_sparse.resize(id + 1, NULL_INDEX);
+		m_sparse[id] = slot;
+
+		m_entities[slot] = entity;
+		m_firstChildren[slot] = NULL_INDEX;
+		Link(slot, parentSlot);
+		SetDepth(slot, parentSlot == NULL_INDEX ? 0 : m_depths[parentSlot] + 1);
+
+		// Appended out of order, with no children yet
+		const uint32_t parentIndex = (parentSlot == NULL_INDEX) ? NULL_INDEX : m_orderIndices[parentSlot];
+		if (parentIndex != NULL_INDEX)
+			ScatterChildren(parentIndex);
+		m_orderIndices[slot] = static_cast<uint32_t>(m_order.size());
+		m_order.push_back(slot);
+		m_orderParents.push_back(parentIndex);
+		m_firstChildIndices.push_back(0);
+		m_childCounts.push_back(0);
+		m_locals.push_back(local);
+		m_worlds.emplace_back();
+		m_dirty.push_back(CLEAN);
+		m_displacedCount++;
+		MarkDirty(slot);
+	}
+	void TransformHierarchy::Remove(entt::entity entity)
+	{
+		const uint32_t slot = GetSlot(entity);
+		if (slot == NULL_INDEX)
+			return;
+
+		// Children keep their world position until the next propagation, after which they are relative to the origin
+		while (m_firstChildren[slot] != NULL_INDEX)
+			SetParent(m_entities[m_firstChildren[slot]], entt::null);
+
+		if (m_parents[slot] != NULL_INDEX)
+			ScatterChildren(m_orderIndices[m_parents[slot]]);
+		Unlink(slot);
+		m_depthCounts[m_depths[slot]]--;
+		m_sparse[static_cast<size_t>(entt::to_entity(entity))] = NULL_INDEX;
+		m_entities[slot] = entt::null;
+		// Any entry left in the dirty levels is filtered out by the hole check
+		const uint32_t index = m_orderIndices[slot];
+		m_order[index] = NULL_INDEX;
+		m_dirty[index] = CLEAN;
+		m_displacedCount++;
+		m_freeSlots.push_back(slot);
+	}
+	bool TransformHierarchy::Contains(entt::entity entity) const
+	{
+		return GetSlot(entity) != NULL_INDEX;
+	}
+	void TransformHierarchy::SetParent(entt::entity entity, entt::entity parent)
+	{
+		const uint32_t slot = GetExistingSlot(entity);
+		const uint32_t parentSlot = (parent == entt::null) ? NULL_INDEX : GetExistingSlot(parent);
+		if (m_parents[slot] == parentSlot)
+			return;
+
+		// Reject parenting a node under its own subtree
+		for (uint32_t ancestor = parentSlot; ancestor != NULL_INDEX; ancestor = m_parents[ancestor])
+		{
+			if (ancestor == slot)
+				Console::Fatal<std::invalid_argument>("Cannot parent entity ", entt::to_integral(entity), " to one of its descendants");
+		}
+
+		if (m_parents[slot] != NULL_INDEX)
+			ScatterChildren(m_orderIndices[m_parents[slot]]);
+		const uint32_t parentIndex = (parentSlot == NULL_INDEX) ? NULL_INDEX : m_orderIndices[parentSlot];
+		if (parentIndex != NULL_INDEX)
+			ScatterChildren(parentIndex);
+		m_orderParents[m_orderIndices[slot]] = parentIndex;
+
+		Unlink(slot);
+		Link(slot, parentSlot);
+		// The node is out of place, and so is every descendant that changed level
+		m_displacedCount += std::max<size_t>(UpdateSubtreeDepths(slot, parentSlot == NULL_INDEX ? 0 : m_depths[parentSlot] + 1), 1);
+		MarkDirty(slot);
+	}
+	entt::entity TransformHierarchy::GetParent(entt::entity entity) const
+	{
+		const uint32_t parent = m_parents[GetExistingSlot(entity)];
+		return parent == NULL_INDEX ? entt::entity(entt::null) : m_entities[parent];
+	}
+	uint32_t TransformHierarchy::GetDepth(entt::entity entity) const
+	{
+		return m_depths[GetExistingSlot(entity)];
+	}
+	const Transform& TransformHierarchy::GetLocal(entt::entity entity) const
+	{
+		return m_locals[m_orderIndices[GetExistingSlot(entity)]];
+	}
+	void TransformHierarchy::SetLocal(entt::entity entity, const Transform& local)
+	{
+		const uint32_t slot = GetExistingSlot(entity);
+		m_locals[m_orderIndices[slot]] = local;
+		MarkDirty(slot);
+	}
+	const Matrix4& TransformHierarchy::GetWorld(entt::entity entity) const
+	{
+		return m_worlds[m_orderIndices[GetExistingSlot(entity)]];
+	}
+	size_t TransformHierarchy::Size() const
+	{
+		return m_entities.size() - m_freeSlots.size();
+	}
+	size_t TransformHierarchy::GetDepthCount() const
+	{
+		size_t depth = m_depthCounts.size();
+		while (depth > 0 && m_depthCounts[depth - 1] == 0)
+			depth--;
+		return depth;
+	}
+	void TransformHierarchy::Reserve(size_t capacity)
+	{
+		m_entities.reserve(capacity);
+		m_parents.reserve(capacity);
+		m_firstChildren.reserve(capacity);
+		m_nextSiblings.reserve(capacity);
+		m_previousSiblings.reserve(capacity);
+		m_depths.reserve(capacity);
+		m_orderIndices.reserve(capacity);
+		m_order.reserve(capacity);
+		m_orderParents.reserve(capacity);
+		m_firstChildIndices.reserve(capacity);
+		m_childCounts.reserve(capacity);
+		m_locals.reserve(capacity);
+		m_worlds.reserve(capacity);
+		m_dirty.reserve(capacity);
+		m_scheduled.reserve(capacity);
+		m_sortedOrder.reserve(capacity);
+		m_sortedLocals.reserve(capacity);
+		m_sortedWorlds.reserve(capacity);
+		m_sortedDirty.reserve(capacity);
+	}
+	void TransformHierarchy::Propagate(ThreadPool* pool, size_t grainSize)
+	{
+		if (m_displacedCount > Size() / COMPACT_DIVISOR)
+			Compact();
+
+		auto updateRange = [this](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				const uint32_t index = m_scheduled[i];
+				const uint32_t parent = m_orderParents[index];
+				m_worlds[index] = (parent == NULL_INDEX) ? m_locals[index].ToMatrix() : m_worlds[parent] * m_locals[index].ToMatrix();
+				m_dirty[index] = CLEAN;
+			}
+		};
+
+		for (uint32_t depth = 0; depth < m_dirtyLevels.size(); depth++)
+		{
+			std::vector<uint32_t>& dirty = m_dirtyLevels[depth];
+			if (dirty.empty())
+				continue;
+
+			// Drop holes, stale and duplicate entries
+			m_scheduled.clear();
+			for (uint32_t index : dirty)
+			{
+				const uint32_t slot = m_order[index];
+				if (slot != NULL_INDEX && m_depths[slot] == depth && m_dirty[index] == PENDING)
+				{
+					m_dirty[index] = SCHEDULED;
+					m_scheduled.push_back(index);
+				}
+			}
+			dirty.clear();
+
+			// Parents are all one level up and already final, so nodes within a level are independent
+			if (pool)
+				pool->ParallelFor(m_scheduled.size(), grainSize, updateRange);
+			else
+				updateRange(0, m_scheduled.size());
+
+			// Children of every recomputed node need recomputing on the next level
+			if (depth + 1 >= m_dirtyLevels.size())
+				continue;
+			std::vector<uint32_t>& next = m_dirtyLevels[depth + 1];
+			for (uint32_t index : m_scheduled)
+			{
+				const uint32_t childCount = m_childCounts[index];
+				if (childCount == NULL_INDEX)
+				{
+					for (uint32_t child = m_firstChildren[m_order[index]]; child != NULL_INDEX; child = m_nextSiblings[child])
+						MarkDirty(child);
+					continue;
+				}
+				const uint32_t end = m_firstChildIndices[index] + childCount;
+				for (uint32_t child = m_firstChildIndices[index]; child < end; child++)
+				{
+					if (m_dirty[child] == CLEAN)
+					{
+						m_dirty[child] = PENDING;
+						next.push_back(child);
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <span>
+#include <vector>
+#include <cstdint>
+#include "entt/entt.hpp"
+#include "Transform.hpp"
+#include "OSDetection.hpp"
+
+namespace CrescendoEngine
+{
+	class ThreadPool;
+
+	// Parent/child relationships between entities with cached world matrices.
+	// Transform data is kept mostly breadth first, so a depth level is one contiguous range and the children of a node
+	// are adjacent. Propagation walks one level at a time, each level in parallel, and only recomputes the subtrees
+	// below nodes that changed since the last pass. Structural edits are incremental: added and re-parented nodes are
+	// appended out of order and removed nodes leave holes, the arrays are compacted back into breadth first order once
+	// more than 1/COMPACT_DIVISOR of the nodes are out of place, keeping the cost amortised O(1) per edit
+	class CS_CORE_EXPORT TransformHierarchy
+	{
+	private:
+		static constexpr uint32_t NULL_INDEX = ~uint32_t(0);
+		static constexpr size_t COMPACT_DIVISOR = 4;
+		// Values of m_dirty
+		static constexpr uint8_t CLEAN = 0, PENDING = 1, SCHEDULED = 2;
+	private:
+		// Structure, indexed by node slot. Slots are stable for the lifetime of a node
+		std::vector<entt::entity> m_entities;
+		std::vector<uint32_t> m_parents;
+		std::vector<uint32_t> m_firstChildren;
+		std::vector<uint32_t> m_nextSiblings;
+		std::vector<uint32_t> m_previousSiblings;
+		std::vector<uint32_t> m_depths;
+		// Position of the node in the transform arrays
+		std::vector<uint32_t> m_orderIndices;
+
+		// Transform data, indexed by position. Nodes added since the last compaction are appended at the end,
+		// removed nodes leave a NULL_INDEX hole in m_order
+		std::vector<uint32_t> m_order;
+		std::vector<uint32_t> m_orderParents;
+		// Range of the children, a count of NULL_INDEX means they are no longer adjacent and the sibling links are used
+		std::vector<uint32_t> m_firstChildIndices;
+		std::vector<uint32_t> m_childCounts;
+		std::vector<Transform> m_locals;
+		std::vector<Matrix4> m_worlds;
+		std::vector<uint8_t> m_dirty;
+		// Nodes appended or moved, and holes left, since the last compaction
+		size_t m_displacedCount = 0;
+
+		// Maps entity ids to node slots
+		std::vector<uint32_t> m_sparse;
+		std::vector<uint32_t> m_freeSlots;
+		// Number of nodes at each depth
+		std::vector<uint32_t> m_depthCounts;
+		// Positions waiting to be recomputed, grouped by depth. May hold stale entries which are filtered out during propagation
+		std::vector<std::vector<uint32_t>> m_dirtyLevels;
+		// Scratch buffers reused between calls
+		std::vector<uint32_t> m_scheduled;
+		std::vector<uint32_t> m_stack;
+		std::vector<uint32_t> m_sortedOrder;
+		std::vector<Transform> m_sortedLocals;
+		std::vector<Matrix4> m_sortedWorlds;
+		std::vector<uint8_t> m_sortedDirty;
+	private:
+		uint32_t GetSlot(entt::entity entity) const;
+		uint32_t GetExistingSlot(entt::entity entity) const;
+		void MarkDirty(uint32_t slot);
+		void SetDepth(uint32_t slot, uint32_t depth);
+		void Link(uint32_t slot, uint32_t parent);
+		void Unlink(uint32_t slot);
+		// Moves the subtree to a new depth, returns the number of nodes moved
+		size_t UpdateSubtreeDepths(uint32_t slot, uint32_t depth);
+		// Stops using the child range of the node at index, its children are no longer adjacent
+		void ScatterChildren(uint32_t index);
+		// Rebuilds the transform arrays breadth first from the roots, dropping holes
+		void Compact();
+	public:
+		TransformHierarchy() = default;
+
+		// Adds an entity to the hierarchy, as a root if parent is null
+		void Add(entt::entity entity, const Transform& local = {}, entt::entity parent = entt::null);
+		// Removes an entity from the hierarchy, its children become roots
+		void Remove(entt::entity entity);
+		// Returns true if the entity is part of the hierarchy
+		bool Contains(entt::entity entity) const;
+		// Moves an entity and its subtree under a new parent, or makes it a root if parent is null
+		void SetParent(entt::entity entity, entt::entity parent);
+		// Returns the parent of the entity, or null if it is a root
+		entt::entity GetParent(entt::entity entity) const;
+		// Returns the depth of the entity, roots have a depth of 0
+		uint32_t GetDepth(entt::entity entity) const;
+		// Returns the local transform of the entity
+		const Transform& GetLocal(entt::entity entity) const;
+		// Replaces the local transform of the entity and marks its subtree for propagation
+		void SetLocal(entt::entity entity, const Transform& local);
+		// Returns the world matrix computed by the last propagation pass
+		const Matrix4& GetWorld(entt::entity entity) const;
+		// Returns the number of entities in the hierarchy
+		size_t Size() const;
+		// Returns the number of depth levels in use
+		size_t GetDepthCount() const;
+		// Preallocates room for the given number of nodes
+		void Reserve(size_t capacity);
+		// Recomputes the world matrices of every dirty subtree, level by level. Each level is split across the pool
+		// in chunks of grainSize, runs on the calling thread when pool is null
+		void Propagate(ThreadPool* pool = nullptr, size_t grainSize = 1024);
+	};
+}
@@ -1,8 +1,18 @@
 #pragma once
+#include <cstdint>
 #include "OSDetection.hpp"
 
 namespace CrescendoEngine
 {
+	// Which threads a module's OnUpdate may be called from
+	enum class UpdateAffinity : uint8_t
+	{
+		// Always called on the main thread, never concurrently with other main thread modules
+		MainThread,
+		// May be called on a worker thread, concurrently with any module it does not depend on or that does not depend on it
+		AnyThread,
+	};
+
 	struct ModuleMetadata
 	{
 		const char* name;
@@ -12,6 +22,7 @@ namespace CrescendoEngine
 		// comma separated list
 		const char* dependencies;
 		double updateInterval;
+		UpdateAffinity updateAffinity = UpdateAffinity::MainThread;
 	};
 
 	class Module
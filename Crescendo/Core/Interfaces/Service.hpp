@@ -0,0 +1,32 @@
+#pragma once
+
+namespace CrescendoEngine
+{
+	// Cached reference to a service registered with Core, obtained through Core::GetServiceHandle<T>().
+	// Points directly at the service's slot, so Get() is a single load with no hashing or casting, and it stays
+	// valid if the service is later unregistered or replaced (Get() returns nullptr or the new provider).
+	// A handle taken before the interface was ever registered is empty and stays empty
+	template<typename T>
+	class ServiceHandle
+	{
+	private:
+		void* const* m_slot = nullptr;
+	public:
+		ServiceHandle() = default;
+		explicit ServiceHandle(void* const* slot) : m_slot(slot) {}
+
+		// Returns the service, or nullptr if none is currently registered
+		T* Get() const
+		{
+			return m_slot ? static_cast<T*>(*m_slot) : nullptr;
+		}
+		T* operator->() const
+		{
+			return Get();
+		}
+		explicit operator bool() const
+		{
+			return Get() != nullptr;
+		}
+	};
+}
@@ -0,0 +1,101 @@
+#include "MappedFile.hpp"
+#include <utility>
+#include <cstdint>
+
+extern "C"
+{
+	__declspec(dllimport) void* __stdcall CreateFileA(const char* lpFileName, unsigned long dwDesiredAccess, unsigned long dwShareMode, void* lpSecurityAttributes, unsigned long dwCreationDisposition, unsigned long dwFlagsAndAttributes, void* hTemplateFile);
+	__declspec(dllimport) int __stdcall GetFileSizeEx(void* hFile, long long* lpFileSize);
+	__declspec(dllimport) void* __stdcall CreateFileMappingA(void* hFile, void* lpFileMappingAttributes, unsigned long flProtect, unsigned long dwMaximumSizeHigh, unsigned long dwMaximumSizeLow, const char* lpName);
+	__declspec(dllimport) void* __stdcall MapViewOfFile(void* hFileMappingObject, unsigned long dwDesiredAccess, unsigned long dwFileOffsetHigh, unsigned long dwFileOffsetLow, size_t dwNumberOfBytesToMap);
+	__declspec(dllimport) int __stdcall UnmapViewOfFile(const void* lpBaseAddress);
+	__declspec(dllimport) int __stdcall CloseHandle(void* hObject);
+}
+
+namespace CrescendoEngine
+{
+	namespace
+	{
+		constexpr unsigned long GENERIC_READ_ACCESS = 0x80000000;
+		constexpr unsigned long SHARE_READ = 0x00000001;
+		constexpr unsigned long OPEN_EXISTING_FILE = 3;
+		constexpr unsigned long SEQUENTIAL_SCAN = 0x08000000;
+		constexpr unsigned long PAGE_READ_ONLY = 0x02;
+		constexpr unsigned long MAP_READ = 0x0004;
+		void* const INVALID_HANDLE = reinterpret_cast<void*>(~uintptr_t(0));
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_data)
+			UnmapViewOfFile(m_data);
+		if (m_mapping)
+			CloseHandle(m_mapping);
+		if (m_file)
+			CloseHandle(m_file);
+		m_file = nullptr;
+		m_mapping = nullptr;
+		m_data = nullptr;
+		m_size = 0;
+	}
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+	MappedFile::MappedFile(MappedFile&& other) noexcept :
+		m_file(std::exchange(other.m_file, nullptr)), m_mapping(std::exchange(other.m_mapping, nullptr)),
+		m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)) {}
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+			m_file = std::exchange(other.m_file, nullptr);
+			m_mapping = std::exchange(other.m_mapping, nullptr);
+			m_data = std::exchange(other.m_data, nullptr);
+			m_size = std::exchange(other.m_size, 0);
+		}
+		return *this;
+	}
+	bool MappedFile::Open(const std::filesystem::path& path)
+	{
+		Close();
+		void* file = CreateFileA(path.string().c_str(), GENERIC_READ_ACCESS, SHARE_READ, nullptr, OPEN_EXISTING_FILE, SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE)
+			return false;
+		m_file = file;
+
+		long long size = 0;
+		if (!GetFileSizeEx(m_file, &size))
+		{
+			Close();
+			return false;
+		}
+		// Empty files cannot be mapped, but are still valid
+		if (size == 0)
+			return true;
+
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READ_ONLY, 0, 0, nullptr);
+		if (m_mapping == nullptr)
+		{
+			Close();
+			return false;
+		}
+		m_data = static_cast<const std::byte*>(MapViewOfFile(m_mapping, MAP_READ, 0, 0, 0));
+		if (m_data == nullptr)
+		{
+			Close();
+			return false;
+		}
+		m_size = static_cast<size_t>(size);
+		return true;
+	}
+	bool MappedFile::IsOpen() const
+	{
+		return m_file != nullptr;
+	}
+	std::span<const std::byte> MappedFile::GetData() const
+	{
+		return { m_data, m_size };
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <span>
+#include <cstddef>
+#include <filesystem>
+#include "OSDetection.hpp"
+
+namespace CrescendoEngine
+{
+	// Read-only memory mapping of a whole file, unmapped on destruction
+	class CS_CORE_EXPORT MappedFile
+	{
+	private:
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+		const std::byte* m_data = nullptr;
+		size_t m_size = 0;
+	private:
+		void Close();
+	public:
+		MappedFile() = default;
+		~MappedFile();
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		// Maps the file, returns false if it could not be opened or mapped
+		bool Open(const std::filesystem::path& path);
+		// Returns true if a file is mapped, empty files count as mapped
+		bool IsOpen() const;
+		// Returns the contents of the file
+		std::span<const std::byte> GetData() const;
+	};
+}
@@ -0,0 +1,185 @@
+#include "ResourceService.hpp"
+#include <algorithm>
+#include "MappedFile.hpp"
+
+namespace CrescendoEngine
+{
+	void ResourceService::ReaderLoop()
+	{
+		while (true)
+		{
+			std::shared_ptr<ResourceEntry> entry;
+			{
+				std::unique_lock lock(m_mutex);
+				m_condition.wait(lock, [this] { return m_stopping || !m_requests.empty(); });
+				if (m_stopping)
+					return;
+				entry = m_requests.top().entry.lock();
+				m_requests.pop();
+				// Released before being served, or a duplicate left behind by a priority bump
+				if (!entry || entry->started.exchange(true))
+					continue;
+				m_activeReads++;
+			}
+			Read(*entry);
+
+			std::vector<std::function<void()>> callbacks;
+			{
+				std::scoped_lock lock(entry->mutex);
+				callbacks.swap(entry->callbacks);
+				entry->condition.notify_all();
+			}
+			std::scoped_lock lock(m_mutex);
+			m_completed.insert(m_completed.end(), std::make_move_iterator(callbacks.begin()), std::make_move_iterator(callbacks.end()));
+			m_activeReads--;
+			m_idleCondition.notify_all();
+		}
+	}
+	void ResourceService::Read(ResourceEntry& entry)
+	{
+		std::shared_ptr<void> data;
+		std::string error;
+		MappedFile file;
+		if (!file.Open(entry.path))
+			error = "Could not open " + entry.path.string();
+		else
+		{
+			try
+			{
+				data = entry.parse(file.GetData());
+			}
+			catch (const std::exception& exception)
+			{
+				error = "Failed to parse " + entry.path.string() + ": " + exception.what();
+			}
+			catch (...)
+			{
+				error = "Failed to parse " + entry.path.string();
+			}
+		}
+		// The parser may hold module state, so drop it as soon as it is no longer needed
+		entry.parse = nullptr;
+
+		std::scoped_lock lock(entry.mutex);
+		entry.data = std::move(data);
+		entry.error = std::move(error);
+		entry.state.store(entry.error.empty() ? ResourceState::Loaded : ResourceState::Failed, std::memory_order_release);
+	}
+	std::shared_ptr<ResourceEntry> ResourceService::Request(const std::filesystem::path& path, entt::id_type type, ParseFunc parse, LoadPriority priority, EntryCallback callback)
+	{
+		std::string key = std::to_string(type) + ':' + path.lexically_normal().string();
+
+		std::scoped_lock lock(m_mutex);
+		std::shared_ptr<ResourceEntry> entry;
+		if (auto it = m_cache.find(key); it != m_cache.end())
+			entry = it->second.lock();
+		if (!entry)
+		{
+			// Forget entries whose last handle was released, amortised over insertions
+			if (m_cache.size() >= m_sweepThreshold)
+			{
+				std::erase_if(m_cache, [](const auto& pair) { return pair.second.expired(); });
+				m_sweepThreshold = std::max<size_t>(64, m_cache.size() * 2);
+			}
+			entry = std::make_shared<ResourceEntry>();
+			entry->path = path;
+			entry->parse = std::move(parse);
+			entry->priority = priority;
+			m_cache[key] = entry;
+			m_requests.push({ priority, m_sequence++, entry });
+			m_condition.notify_one();
+		}
+		else if (priority > entry->priority && !entry->started.load())
+		{
+			// Queue again at the higher priority, whichever copy is served first wins
+			entry->priority = priority;
+			m_requests.push({ priority, m_sequence++, entry });
+			m_condition.notify_one();
+		}
+
+		if (callback)
+		{
+			std::function<void()> bound = [entry, callback = std::move(callback)] { callback(entry); };
+			std::scoped_lock entryLock(entry->mutex);
+			if (entry->state.load() == ResourceState::Pending)
+				entry->callbacks.push_back(std::move(bound));
+			else
+				m_completed.push_back(std::move(bound));
+		}
+		return entry;
+	}
+	ResourceService::ResourceService(size_t readerCount)
+	{
+		m_readers.reserve(readerCount);
+		for (size_t i = 0; i < readerCount; i++)
+			m_readers.emplace_back(&ResourceService::ReaderLoop, this);
+	}
+	ResourceService::~ResourceService()
+	{
+		{
+			std::scoped_lock lock(m_mutex);
+			m_stopping = true;
+		}
+		m_condition.notify_all();
+		for (std::thread& reader : m_readers)
+			reader.join();
+		CancelAll();
+	}
+	ResourceHandle<std::vector<std::byte>> ResourceService::LoadBytes(
+		const std::filesystem::path& path, LoadPriority priority,
+		std::function<void(const ResourceHandle<std::vector<std::byte>>&)> callback
+	) {
+		return Load<std::vector<std::byte>>(path, [](std::span<const std::byte> bytes) {
+			return std::vector<std::byte>(bytes.begin(), bytes.end());
+		}, priority, std::move(callback));
+	}
+	void ResourceService::Update()
+	{
+		std::vector<std::function<void()>> completed;
+		{
+			std::scoped_lock lock(m_mutex);
+			if (m_completed.empty())
+				return;
+			completed.swap(m_completed);
+		}
+		for (auto& callback : completed)
+			callback();
+	}
+	size_t ResourceService::GetCachedCount()
+	{
+		std::scoped_lock lock(m_mutex);
+		size_t count = 0;
+		for (const auto& [key, entry] : m_cache)
+			count += !entry.expired();
+		return count;
+	}
+	void ResourceService::CancelAll()
+	{
+		std::vector<std::function<void()>> dropped;
+		std::unique_lock lock(m_mutex);
+		m_requests = {};
+		// Parsers may live in module code, so let the reads in progress finish
+		m_idleCondition.wait(lock, [this] { return m_activeReads == 0; });
+		dropped.swap(m_completed);
+		// Callbacks hold their entry, so clearing them also breaks those references
+		for (const auto& [key, weakEntry] : m_cache)
+		{
+			if (auto entry = weakEntry.lock())
+			{
+				std::scoped_lock entryLock(entry->mutex);
+				for (auto& callback : entry->callbacks)
+					dropped.push_back(std::move(callback));
+				entry->callbacks.clear();
+				// Never going to be read now, release anyone waiting on it
+				if (!entry->started.exchange(true))
+				{
+					entry->parse = nullptr;
+					entry->error = "Cancelled";
+					entry->state.store(ResourceState::Failed, std::memory_order_release);
+					entry->condition.notify_all();
+				}
+			}
+		}
+		m_cache.clear();
+	}
+}
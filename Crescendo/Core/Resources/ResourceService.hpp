@@ -0,0 +1,166 @@
+#pragma once
+#include <span>
+#include <queue>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <filesystem>
+#include <unordered_map>
+#include <condition_variable>
+#include "entt/entt.hpp"
+#include "OSDetection.hpp"
+
+namespace CrescendoEngine
+{
+	// Order in which queued requests are served, requests of equal priority are served first come first served
+	enum class LoadPriority : uint8_t
+	{
+		Low,
+		Normal,
+		High,
+	};
+
+	enum class ResourceState : uint8_t
+	{
+		Pending,
+		Loaded,
+		Failed,
+	};
+
+	// Shared state of one cached resource, owned by the handles that reference it
+	struct ResourceEntry
+	{
+		std::filesystem::path path;
+		std::function<std::shared_ptr<void>(std::span<const std::byte>)> parse;
+		std::atomic<ResourceState> state = ResourceState::Pending;
+		// Set once a reader has taken the request, later duplicates in the queue are skipped
+		std::atomic<bool> started = false;
+		LoadPriority priority = LoadPriority::Normal;
+
+		// Guarded by mutex until state leaves Pending, immutable afterwards
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::shared_ptr<void> data;
+		std::string error;
+		// Completion callbacks, run on the main thread by ResourceService::Update. They hold the entry, keeping it alive until they have run
+		std::vector<std::function<void()>> callbacks;
+	};
+
+	// Reference counted handle to a resource of type T, doubles as a future for its completion
+	template<typename T>
+	class ResourceHandle
+	{
+	private:
+		std::shared_ptr<ResourceEntry> m_entry;
+	public:
+		ResourceHandle() = default;
+		explicit ResourceHandle(std::shared_ptr<ResourceEntry> entry) : m_entry(std::move(entry)) {}
+
+		// Returns true if the handle refers to a resource
+		bool IsValid() const { return m_entry != nullptr; }
+		// Returns true once loading has finished, successfully or not
+		bool IsReady() const { return m_entry && m_entry->state.load(std::memory_order_acquire) != ResourceState::Pending; }
+		// Returns true if the resource loaded successfully
+		bool IsLoaded() const { return m_entry && m_entry->state.load(std::memory_order_acquire) == ResourceState::Loaded; }
+		// Returns true if the file could not be read or parsed
+		bool HasFailed() const { return m_entry && m_entry->state.load(std::memory_order_acquire) == ResourceState::Failed; }
+		// Returns the reason loading failed, only meaningful once HasFailed() is true
+		const std::string& GetError() const { return m_entry->error; }
+		const std::filesystem::path& GetPath() const { return m_entry->path; }
+		// Returns the parsed resource, or nullptr if it is not loaded
+		const T* Get() const { return IsLoaded() ? static_cast<const T*>(m_entry->data.get()) : nullptr; }
+		const T* operator->() const { return Get(); }
+		// Blocks until loading has finished, prefer callbacks or polling IsReady() from the main loop
+		void Wait() const
+		{
+			std::unique_lock lock(m_entry->mutex);
+			m_entry->condition.wait(lock, [this] { return m_entry->state.load() != ResourceState::Pending; });
+		}
+	};
+
+	// Loads files on background reader threads through memory mapping and caches the parsed results.
+	// Requests for a resource that is already cached or in flight share the same entry, and entries are
+	// dropped from the cache once the last handle to them is released. Completion callbacks always run on the main thread.
+	class CS_CORE_EXPORT ResourceService
+	{
+	private:
+		using ParseFunc = std::function<std::shared_ptr<void>(std::span<const std::byte>)>;
+		using EntryCallback = std::function<void(std::shared_ptr<ResourceEntry>)>;
+		struct Request
+		{
+			LoadPriority priority;
+			uint64_t sequence;
+			// Weak so that requests nobody holds a handle to anymore are skipped
+			std::weak_ptr<ResourceEntry> entry;
+
+			bool operator<(const Request& other) const
+			{
+				if (priority != other.priority)
+					return priority < other.priority;
+				return sequence > other.sequence;
+			}
+		};
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		std::priority_queue<Request> m_requests;
+		uint64_t m_sequence = 0;
+		// Keyed by type hash and path
+		std::unordered_map<std::string, std::weak_ptr<ResourceEntry>> m_cache;
+		size_t m_sweepThreshold = 64;
+		// Callbacks ready to run on the main thread
+		std::vector<std::function<void()>> m_completed;
+		std::vector<std::thread> m_readers;
+		// Number of requests being read right now, CancelAll waits for it to reach zero
+		size_t m_activeReads = 0;
+		std::condition_variable m_idleCondition;
+		bool m_stopping = false;
+	private:
+		void ReaderLoop();
+		void Read(ResourceEntry& entry);
+		std::shared_ptr<ResourceEntry> Request(const std::filesystem::path& path, entt::id_type type, ParseFunc parse, LoadPriority priority, EntryCallback callback);
+	public:
+		// Starts readerCount background reader threads
+		explicit ResourceService(size_t readerCount = 2);
+		~ResourceService();
+		ResourceService(const ResourceService&) = delete;
+		ResourceService& operator=(const ResourceService&) = delete;
+
+		// Requests a file parsed into T by parse, which runs on a reader thread with the mapped contents of the file.
+		// The callback, if any, runs on the main thread once the resource has finished loading, even if it already had,
+		// and keeps the resource alive until then. Without a callback, releasing every handle cancels the request
+		template<typename T>
+		ResourceHandle<T> Load(
+			const std::filesystem::path& path, std::function<T(std::span<const std::byte>)> parse,
+			LoadPriority priority = LoadPriority::Normal, std::function<void(const ResourceHandle<T>&)> callback = nullptr
+		) {
+			ParseFunc erased = [parse = std::move(parse)](std::span<const std::byte> bytes) -> std::shared_ptr<void> {
+				return std::make_shared<T>(parse(bytes));
+			};
+			EntryCallback erasedCallback;
+			if (callback)
+			{
+				erasedCallback = [callback = std::move(callback)](std::shared_ptr<ResourceEntry> entry) {
+					callback(ResourceHandle<T>(std::move(entry)));
+				};
+			}
+			return ResourceHandle<T>(Request(path, entt::type_hash<T>::value(), std::move(erased), priority, std::move(erasedCallback)));
+		}
+		// Requests the raw contents of a file
+		ResourceHandle<std::vector<std::byte>> LoadBytes(
+			const std::filesystem::path& path, LoadPriority priority = LoadPriority::Normal,
+			std::function<void(const ResourceHandle<std::vector<std::byte>>&)> callback = nullptr
+		);
+		// Runs the callbacks of every request that finished since the last call, called by Core on the main thread each tick
+		void Update();
+		// Returns the number of resources that are cached or in flight
+		size_t GetCachedCount();
+		// Drops every queued request and pending callback after waiting for reads in progress, called by Core before modules are unloaded
+		void CancelAll();
+	};
+}
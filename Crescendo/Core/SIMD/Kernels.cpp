@@ -0,0 +1,204 @@
+#include "Kernels.hpp"
+#include <algorithm>
+#include <immintrin.h>
+#ifdef _MSC_VER
+	#include <intrin.h>
+	// MSVC allows AVX2 intrinsics without /arch:AVX2, so nothing extra is needed per function
+	#define CS_TARGET_AVX2
+#else
+	#include <cpuid.h>
+	#define CS_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+namespace CrescendoEngine::SIMD
+{
+	namespace
+	{
+		using AxpyFunc = void(*)(float, const float*, float*, size_t);
+		using ScaleFunc = void(*)(float, float*, size_t);
+		using ClampFunc = void(*)(float*, float, float, size_t);
+		using LerpFunc = void(*)(float*, const float*, float, size_t);
+
+		struct KernelTable
+		{
+			SIMDLevel level;
+			AxpyFunc axpy;
+			ScaleFunc scale;
+			ClampFunc clamp;
+			LerpFunc lerp;
+		};
+
+		// Scalar fallbacks, also used for the tails of the vectorised loops
+		void AxpyScalar(float a, const float* x, float* y, size_t count)
+		{
+			for (size_t i = 0; i < count; i++)
+				y[i] += a * x[i];
+		}
+		void ScaleScalar(float a, float* x, size_t count)
+		{
+			for (size_t i = 0; i < count; i++)
+				x[i] *= a;
+		}
+		void ClampScalar(float* x, float lo, float hi, size_t count)
+		{
+			for (size_t i = 0; i < count; i++)
+				x[i] = std::min(std::max(x[i], lo), hi);
+		}
+		void LerpScalar(float* a, const float* b, float t, size_t count)
+		{
+			for (size_t i = 0; i < count; i++)
+				a[i] += (b[i] - a[i]) * t;
+		}
+
+		// SSE2, always available on x64
+		void AxpySSE2(float a, const float* x, float* y, size_t count)
+		{
+			const __m128 va = _mm_set1_ps(a);
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+				_mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(va, _mm_loadu_ps(x + i))));
+			AxpyScalar(a, x + i, y + i, count - i);
+		}
+		void ScaleSSE2(float a, float* x, size_t count)
+		{
+			const __m128 va = _mm_set1_ps(a);
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+				_mm_storeu_ps(x + i, _mm_mul_ps(va, _mm_loadu_ps(x + i)));
+			ScaleScalar(a, x + i, count - i);
+		}
+		void ClampSSE2(float* x, float lo, float hi, size_t count)
+		{
+			const __m128 vlo = _mm_set1_ps(lo);
+			const __m128 vhi = _mm_set1_ps(hi);
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+				_mm_storeu_ps(x + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(x + i), vlo), vhi));
+			ClampScalar(x + i, lo, hi, count - i);
+		}
+		void LerpSSE2(float* a, const float* b, float t, size_t count)
+		{
+			const __m128 vt = _mm_set1_ps(t);
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128 va = _mm_loadu_ps(a + i);
+				_mm_storeu_ps(a + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + i), va), vt)));
+			}
+			LerpScalar(a + i, b + i, t, count - i);
+		}
+
+		// AVX2 + FMA, only selected when the CPU and OS report support
+		CS_TARGET_AVX2 void AxpyAVX2(float a, const float* x, float* y, size_t count)
+		{
+			const __m256 va = _mm256_set1_ps(a);
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+				_mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+			AxpyScalar(a, x + i, y + i, count - i);
+		}
+		CS_TARGET_AVX2 void ScaleAVX2(float a, float* x, size_t count)
+		{
+			const __m256 va = _mm256_set1_ps(a);
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+				_mm256_storeu_ps(x + i, _mm256_mul_ps(va, _mm256_loadu_ps(x + i)));
+			ScaleScalar(a, x + i, count - i);
+		}
+		CS_TARGET_AVX2 void ClampAVX2(float* x, float lo, float hi, size_t count)
+		{
+			const __m256 vlo = _mm256_set1_ps(lo);
+			const __m256 vhi = _mm256_set1_ps(hi);
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+				_mm256_storeu_ps(x + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(x + i), vlo), vhi));
+			ClampScalar(x + i, lo, hi, count - i);
+		}
+		CS_TARGET_AVX2 void LerpAVX2(float* a, const float* b, float t, size_t count)
+		{
+			const __m256 vt = _mm256_set1_ps(t);
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				const __m256 va = _mm256_loadu_ps(a + i);
+				_mm256_storeu_ps(a + i, _mm256_fmadd_ps(_mm256_sub_ps(_mm256_loadu_ps(b + i), va), vt, va));
+			}
+			LerpScalar(a + i, b + i, t, count - i);
+		}
+
+		constexpr KernelTable s_tables[] = {
+			{ SIMDLevel::Scalar, AxpyScalar, ScaleScalar, ClampScalar, LerpScalar },
+			{ SIMDLevel::SSE2, AxpySSE2, ScaleSSE2, ClampSSE2, LerpSSE2 },
+			{ SIMDLevel::AVX2, AxpyAVX2, ScaleAVX2, ClampAVX2, LerpAVX2 },
+		};
+
+		SIMDLevel DetectLevel()
+		{
+			int info[4] = {};
+			#ifdef _MSC_VER
+				__cpuid(info, 0);
+				const int maxLeaf = info[0];
+				__cpuid(info, 1);
+			#else
+				const int maxLeaf = static_cast<int>(__get_cpuid_max(0, nullptr));
+				__cpuid(1, info[0], info[1], info[2], info[3]);
+			#endif
+			const bool fma = (info[2] & (1 << 12)) != 0;
+			const bool osxsave = (info[2] & (1 << 27)) != 0;
+			const bool avx = (info[2] & (1 << 28)) != 0;
+			if (maxLeaf < 7 || !fma || !osxsave || !avx)
+				return SIMDLevel::SSE2;
+
+			// The OS must save the YMM registers on context switches
+			#ifdef _MSC_VER
+				const unsigned long long xcr0 = _xgetbv(0);
+			#else
+				unsigned int xcrLow, xcrHigh;
+				__asm__("xgetbv" : "=a"(xcrLow), "=d"(xcrHigh) : "c"(0));
+				const unsigned long long xcr0 = (static_cast<unsigned long long>(xcrHigh) << 32) | xcrLow;
+			#endif
+			if ((xcr0 & 0x6) != 0x6)
+				return SIMDLevel::SSE2;
+
+			#ifdef _MSC_VER
+				__cpuidex(info, 7, 0);
+			#else
+				__cpuid_count(7, 0, info[0], info[1], info[2], info[3]);
+			#endif
+			const bool avx2 = (info[1] & (1 << 5)) != 0;
+			return avx2 ? SIMDLevel::AVX2 : SIMDLevel::SSE2;
+		}
+
+		const SIMDLevel s_supportedLevel = DetectLevel();
+		const KernelTable* s_kernels = &s_tables[static_cast<size_t>(s_supportedLevel)];
+	}
+
+	SIMDLevel GetLevel()
+	{
+		return s_kernels->level;
+	}
+	SIMDLevel GetSupportedLevel()
+	{
+		return s_supportedLevel;
+	}
+	void SetLevel(SIMDLevel level)
+	{
+		s_kernels = &s_tables[static_cast<size_t>(std::min(level, s_supportedLevel))];
+	}
+	void Axpy(float a, const float* x, float* y, size_t count)
+	{
+		s_kernels->axpy(a, x, y, count);
+	}
+	void Scale(float a, float* x, size_t count)
+	{
+		s_kernels->scale(a, x, count);
+	}
+	void Clamp(float* x, float lo, float hi, size_t count)
+	{
+		s_kernels->clamp(x, lo, hi, count);
+	}
+	void Lerp(float* a, const float* b, float t, size_t count)
+	{
+		s_kernels->lerp(a, b, t, count);
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "OSDetection.hpp"
+
+namespace CrescendoEngine
+{
+	// Instruction sets the bulk kernels can be dispatched to
+	enum class SIMDLevel : uint8_t
+	{
+		Scalar,
+		SSE2,
+		AVX2,
+	};
+
+	// Small library of vectorised float kernels, intended to be used on the field spans handed out by SoAStorage.
+	// The implementation is chosen once at startup based on what the CPU supports, unaligned inputs are allowed
+	// but aligned spans are faster.
+	namespace SIMD
+	{
+		// Returns the instruction set the kernels are currently dispatched to
+		CS_CORE_EXPORT SIMDLevel GetLevel();
+		// Returns the best instruction set supported by this CPU
+		CS_CORE_EXPORT SIMDLevel GetSupportedLevel();
+		// Forces the kernels to a specific instruction set, clamped to what the CPU supports. Not thread-safe
+		CS_CORE_EXPORT void SetLevel(SIMDLevel level);
+
+		// y[i] += a * x[i]
+		CS_CORE_EXPORT void Axpy(float a, const float* x, float* y, size_t count);
+		// x[i] *= a
+		CS_CORE_EXPORT void Scale(float a, float* x, size_t count);
+		// x[i] = min(max(x[i], lo), hi)
+		CS_CORE_EXPORT void Clamp(float* x, float lo, float hi, size_t count);
+		// a[i] += (b[i] - a[i]) * t
+		CS_CORE_EXPORT void Lerp(float* a, const float* b, float t, size_t count);
+	}
+}
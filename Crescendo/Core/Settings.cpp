@@ -0,0 +1,33 @@
+#include "Settings.hpp"
+#include <algorithm>
+
+namespace CrescendoEngine
+{
+	const Settings::Value* Settings::FindValue(std::string_view key) const
+	{
+		auto it = std::lower_bound(m_values.begin(), m_values.end(), key, [](const auto& pair, std::string_view key) { return pair.first < key; });
+		if (it == m_values.end() || it->first != key)
+			return nullptr;
+		return &it->second;
+	}
+	void Settings::Set(std::string key, Value value)
+	{
+		auto it = std::lower_bound(m_values.begin(), m_values.end(), key, [](const auto& pair, const std::string& key) { return pair.first < key; });
+		if (it != m_values.end() && it->first == key)
+			it->second = std::move(value);
+		else
+			m_values.emplace(it, std::move(key), std::move(value));
+	}
+	void Settings::Clear()
+	{
+		m_values.clear();
+	}
+	bool Settings::Contains(std::string_view key) const
+	{
+		return FindValue(key) != nullptr;
+	}
+	size_t Settings::Size() const
+	{
+		return m_values.size();
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <variant>
+#include <optional>
+#include <algorithm>
+#include <string_view>
+#include <type_traits>
+#include "OSDetection.hpp"
+
+namespace CrescendoEngine
+{
+	// Flattened view of the "settings" object of the config file. Nested keys are joined with '.', and array
+	// elements are addressed by index, e.g. "reserve.entities" or "spawns.0.name".
+	// Parsed once at startup, lookups are a binary search over a sorted table and never allocate
+	class CS_CORE_EXPORT Settings
+	{
+	public:
+		using Value = std::variant<bool, int64_t, double, std::string>;
+	private:
+		// Sorted by key
+		std::vector<std::pair<std::string, Value>> m_values;
+	private:
+		const Value* FindValue(std::string_view key) const;
+	public:
+		// Sets or replaces a value
+		void Set(std::string key, Value value);
+		// Removes every value
+		void Clear();
+		// Returns true if the key exists
+		bool Contains(std::string_view key) const;
+		// Returns the number of values
+		size_t Size() const;
+
+		// Returns the value converted to T, or nothing if the key is missing or holds an incompatible type.
+		// Integers convert to any arithmetic type, floating point values only to floating point types
+		template<typename T>
+		std::optional<T> Find(std::string_view key) const
+		{
+			const Value* value = FindValue(key);
+			if (value == nullptr)
+				return std::nullopt;
+			if constexpr (std::is_same_v<T, bool>)
+			{
+				if (const bool* result = std::get_if<bool>(value))
+					return *result;
+			}
+			else if constexpr (std::is_integral_v<T>)
+			{
+				if (const int64_t* result = std::get_if<int64_t>(value))
+					return static_cast<T>(*result);
+			}
+			else if constexpr (std::is_floating_point_v<T>)
+			{
+				if (const double* result = std::get_if<double>(value))
+					return static_cast<T>(*result);
+				if (const int64_t* result = std::get_if<int64_t>(value))
+					return static_cast<T>(*result);
+			}
+			else if constexpr (std::is_same_v<T, std::string_view>)
+			{
+				if (const std::string* result = std::get_if<std::string>(value))
+					return std::string_view(*result);
+			}
+			else
+				static_assert(!sizeof(T), "Unsupported settings type");
+			return std::nullopt;
+		}
+		// Returns the value converted to T, or fallback if it is missing or of an incompatible type
+		template<typename T>
+		T Get(std::string_view key, T fallback) const
+		{
+			return Find<T>(key).value_or(fallback);
+		}
+		// Calls func(suffix, value) for every key starting with prefix, in key order
+		template<typename Func>
+		void ForEachWithPrefix(std::string_view prefix, Func&& func) const
+		{
+			auto it = std::lower_bound(m_values.begin(), m_values.end(), prefix, [](const auto& pair, std::string_view key) { return pair.first < key; });
+			for (; it != m_values.end() && std::string_view(it->first).starts_with(prefix); it++)
+				func(std::string_view(it->first).substr(prefix.size()), it->second);
+		}
+	};
+}
@@ -0,0 +1,285 @@
+#include "DynamicBVH.hpp"
+#include <queue>
+#include <algorithm>
+
+namespace CrescendoEngine
+{
+	uint32_t DynamicBVH::AllocateNode()
+	{
+		uint32_t node;
+		if (!m_freeNodes.empty())
+		{
+			node = m_freeNodes.back();
+			m_freeNodes.pop_back();
+		}
+		else
+		{
+			node = static_cast<uint32_t>(m_nodes.size());
+			m_nodes.emplace_back();
+		}
+		m_nodes[node].parent = NULL_INDEX;
+		m_nodes[node].left = NULL_INDEX;
+		m_nodes[node].right = NULL_INDEX;
+		m_nodes[node].entity = entt::null;
+		return node;
+	}
+	void DynamicBVH::FreeNode(uint32_t node)
+	{
+		m_nodes[node].entity = entt::null;
+		m_freeNodes.push_back(node);
+	}
+	AABB DynamicBVH::Merge(const AABB& a, const AABB& b)
+	{
+		return {
+			{ std::min(a.min[0], b.min[0]), std::min(a.min[1], b.min[1]), std::min(a.min[2], b.min[2]) },
+			{ std::max(a.max[0], b.max[0]), std::max(a.max[1], b.max[1]), std::max(a.max[2], b.max[2]) }
+		};
+	}
+	float DynamicBVH::SurfaceArea(const AABB& box)
+	{
+		const float x = box.max[0] - box.min[0], y = box.max[1] - box.min[1], z = box.max[2] - box.min[2];
+		return 2.0f * (x * y + y * z + z * x);
+	}
+	bool DynamicBVH::Overlaps(const AABB& a, const AABB& b)
+	{
+		return a.min[0] <= b.max[0] && a.max[0] >= b.min[0] &&
+			a.min[1] <= b.max[1] && a.max[1] >= b.min[1] &&
+			a.min[2] <= b.max[2] && a.max[2] >= b.min[2];
+	}
+	void DynamicBVH::Refit(uint32_t node)
+	{
+		for (; node != NULL_INDEX; node = m_nodes[node].parent)
+			m_nodes[node].bounds = Merge(m_nodes[m_nodes[node].left].bounds, m_nodes[m_nodes[node].right].bounds);
+	}
+	void DynamicBVH::InsertLeaf(uint32_t leaf)
+	{
+		if (m_root == NULL_INDEX)
+		{
+			m_root = leaf;
+			m_nodes[leaf].parent = NULL_INDEX;
+			return;
+		}
+
+		// Descend towards the sibling that grows the total surface area the least
+		const AABB leafBounds = m_nodes[leaf].bounds;
+		uint32_t sibling = m_root;
+		while (!m_nodes[sibling].IsLeaf())
+		{
+			const Node& node = m_nodes[sibling];
+			const float area = SurfaceArea(node.bounds);
+			const float combinedArea = SurfaceArea(Merge(node.bounds, leafBounds));
+			// Cost of making a new parent for this node and the leaf, and the cost pushed onto the children
+			const float cost = 2.0f * combinedArea;
+			const float inheritance = 2.0f * (combinedArea - area);
+
+			auto childCost = [&](uint32_t child) {
+				const AABB merged = Merge(m_nodes[child].bounds, leafBounds);
+				if (m_nodes[child].IsLeaf())
+					return SurfaceArea(merged) + inheritance;
+				return SurfaceArea(merged) - SurfaceArea(m_nodes[child].bounds) + inheritance;
+			};
+			const float leftCost = childCost(node.left);
+			const float rightCost = childCost(node.right);
+			if (cost < leftCost && cost < rightCost)
+				break;
+			sibling = leftCost < rightCost ? node.left : node.right;
+		}
+
+		const uint32_t oldParent = m_nodes[sibling].parent;
+		const uint32_t newParent = AllocateNode();
+		m_nodes[newParent].parent = oldParent;
+		m_nodes[newParent].left = sibling;
+		m_nodes[newParent].right = leaf;
+		m_nodes[newParent].bounds = Merge(leafBounds, m_nodes[sibling].bounds);
+		m_nodes[sibling].parent = newParent;
+		m_nodes[leaf].parent = newParent;
+
+		if (oldParent == NULL_INDEX)
+			m_root = newParent;
+		else if (m_nodes[oldParent].left == sibling)
+			m_nodes[oldParent].left = newParent;
+		else
+			m_nodes[oldParent].right = newParent;
+		Refit(oldParent);
+	}
+	void DynamicBVH::RemoveLeaf(uint32_t leaf)
+	{
+		if (leaf == m_root)
+		{
+			m_root = NULL_INDEX;
+			return;
+		}
+
+		// Replace the parent with the sibling
+		const uint32_t parent = m_nodes[leaf].parent;
+		const uint32_t grandParent = m_nodes[parent].parent;
+		const uint32_t sibling = m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+		m_nodes[sibling].parent = grandParent;
+		if (grandParent == NULL_INDEX)
+			m_root = sibling;
+		else if (m_nodes[grandParent].left == parent)
+			m_nodes[grandParent].left = sibling;
+		else
+			m_nodes[grandParent].right = sibling;
+		FreeNode(parent);
+		Refit(grandParent);
+	}
+	DynamicBVH::DynamicBVH(float margin) : m_margin(margin) {}
+	void DynamicBVH::Update(entt::entity entity, const Vec3& position)
+	{
+		uint32_t leaf = GetSlot(entity);
+		const bool exists = leaf != NULL_INDEX && m_nodes[leaf].entity == entity;
+		if (exists)
+		{
+			m_nodes[leaf].position = position;
+			if (IsInside(m_nodes[leaf].bounds, position))
+				return;
+			RemoveLeaf(leaf);
+		}
+		else
+		{
+			leaf = AllocateNode();
+			m_nodes[leaf].entity = entity;
+			m_nodes[leaf].position = position;
+			SetSlot(entity, leaf);
+			m_leafCount++;
+		}
+
+		m_nodes[leaf].bounds = {
+			{ position[0] - m_margin, position[1] - m_margin, position[2] - m_margin },
+			{ position[0] + m_margin, position[1] + m_margin, position[2] + m_margin }
+		};
+		InsertLeaf(leaf);
+	}
+	void DynamicBVH::Remove(entt::entity entity)
+	{
+		const uint32_t leaf = GetSlot(entity);
+		if (leaf == NULL_INDEX || m_nodes[leaf].entity != entity)
+			return;
+		RemoveLeaf(leaf);
+		FreeNode(leaf);
+		SetSlot(entity, NULL_INDEX);
+		m_leafCount--;
+	}
+	bool DynamicBVH::Contains(entt::entity entity) const
+	{
+		const uint32_t leaf = GetSlot(entity);
+		return leaf != NULL_INDEX && m_nodes[leaf].entity == entity;
+	}
+	size_t DynamicBVH::Size() const
+	{
+		return m_leafCount;
+	}
+	void DynamicBVH::Clear()
+	{
+		m_root = NULL_INDEX;
+		m_leafCount = 0;
+		m_nodes.clear();
+		m_freeNodes.clear();
+		ClearSlots();
+	}
+	void DynamicBVH::Reserve(size_t capacity)
+	{
+		// A tree with n leaves has n - 1 internal nodes
+		m_nodes.reserve(capacity * 2);
+	}
+	template<typename Prune, typename Visit>
+	void DynamicBVH::Traverse(Prune&& prune, Visit&& visit) const
+	{
+		if (m_root == NULL_INDEX)
+			return;
+		// Depth first with a local stack so concurrent queries never share state, balanced trees rarely need more than this
+		uint32_t stack[64];
+		std::vector<uint32_t> overflow;
+		size_t size = 0;
+		stack[size++] = m_root;
+		while (size > 0)
+		{
+			const Node& node = m_nodes[stack[--size]];
+			if (!overflow.empty())
+			{
+				stack[size++] = overflow.back();
+				overflow.pop_back();
+			}
+			if (prune(node.bounds))
+				continue;
+			if (node.IsLeaf())
+			{
+				visit(node);
+				continue;
+			}
+			for (uint32_t child : { node.left, node.right })
+			{
+				if (size < std::size(stack))
+					stack[size++] = child;
+				else
+					overflow.push_back(child);
+			}
+		}
+	}
+	void DynamicBVH::QueryRadius(const Vec3& center, float radius, std::vector<entt::entity>& out) const
+	{
+		const float radiusSquared = radius * radius;
+		Traverse(
+			[&](const AABB& bounds) { return DistanceSquared(bounds, center) > radiusSquared; },
+			[&](const Node& leaf) {
+				if (DistanceSquared(leaf.position, center) <= radiusSquared)
+					out.push_back(leaf.entity);
+			}
+		);
+	}
+	void DynamicBVH::QueryAABB(const AABB& box, std::vector<entt::entity>& out) const
+	{
+		Traverse(
+			[&](const AABB& bounds) { return !Overlaps(bounds, box); },
+			[&](const Node& leaf) {
+				if (IsInside(box, leaf.position))
+					out.push_back(leaf.entity);
+			}
+		);
+	}
+	void DynamicBVH::QueryNearest(const Vec3& point, size_t count, std::vector<entt::entity>& out) const
+	{
+		if (count == 0 || m_root == NULL_INDEX)
+			return;
+
+		// Best first search, nodes are visited in order of their distance lower bound
+		using Entry = std::pair<float, uint32_t>;
+		std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+		open.emplace(DistanceSquared(m_nodes[m_root].bounds, point), m_root);
+		std::vector<Entry> best;
+		best.reserve(count + 1);
+
+		while (!open.empty())
+		{
+			const auto [bound, index] = open.top();
+			open.pop();
+			if (best.size() == count && bound >= best.front().first)
+				break;
+
+			const Node& node = m_nodes[index];
+			if (node.IsLeaf())
+			{
+				const float distance = DistanceSquared(node.position, point);
+				if (best.size() < count)
+				{
+					best.emplace_back(distance, index);
+					std::push_heap(best.begin(), best.end());
+				}
+				else if (distance < best.front().first)
+				{
+					std::pop_heap(best.begin(), best.end());
+					best.back() = { distance, index };
+					std::push_heap(best.begin(), best.end());
+				}
+				continue;
+			}
+			open.emplace(DistanceSquared(m_nodes[node.left].bounds, point), node.left);
+			open.emplace(DistanceSquared(m_nodes[node.right].bounds, point), node.right);
+		}
+
+		std::sort_heap(best.begin(), best.end());
+		for (const auto& [distance, index] : best)
+			out.push_back(m_nodes[index].entity);
+	}
+}
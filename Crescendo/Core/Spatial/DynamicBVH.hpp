@@ -0,0 +1,59 @@
+#pragma once
+#include "SpatialIndex.hpp"
+
+namespace CrescendoEngine
+{
+	// Dynamic bounding volume hierarchy over entity positions. Leaves are fattened by a margin so that small moves
+	// only update the stored position, larger moves remove and reinsert the leaf using a surface area heuristic.
+	// Adapts to clustered or very unevenly distributed scenes better than a uniform grid
+	class CS_CORE_EXPORT DynamicBVH : public SpatialIndex
+	{
+	private:
+		struct Node
+		{
+			AABB bounds;
+			uint32_t parent;
+			// Both NULL_INDEX for leaves
+			uint32_t left;
+			uint32_t right;
+			// Leaf data
+			entt::entity entity;
+			Vec3 position;
+
+			bool IsLeaf() const { return left == NULL_INDEX; }
+		};
+	private:
+		float m_margin;
+		uint32_t m_root = NULL_INDEX;
+		size_t m_leafCount = 0;
+		std::vector<Node> m_nodes;
+		std::vector<uint32_t> m_freeNodes;
+	private:
+		uint32_t AllocateNode();
+		void FreeNode(uint32_t node);
+		void InsertLeaf(uint32_t leaf);
+		void RemoveLeaf(uint32_t leaf);
+		void Refit(uint32_t node);
+		// Visits every leaf whose ancestors and own bounds are not rejected by prune
+		template<typename Prune, typename Visit>
+		void Traverse(Prune&& prune, Visit&& visit) const;
+		static AABB Merge(const AABB& a, const AABB& b);
+		static float SurfaceArea(const AABB& box);
+		static bool Overlaps(const AABB& a, const AABB& b);
+	public:
+		// margin is how far an entity can move before its leaf is reinserted
+		explicit DynamicBVH(float margin = 0.5f);
+
+		void Update(entt::entity entity, const Vec3& position) override;
+		void Remove(entt::entity entity) override;
+		bool Contains(entt::entity entity) const override;
+		size_t Size() const override;
+		void Clear() override;
+		// Preallocates room for the given number of entities
+		void Reserve(size_t capacity);
+
+		void QueryRadius(const Vec3& center, float radius, std::vector<entt::entity>& out) const override;
+		void QueryAABB(const AABB& box, std::vector<entt::entity>& out) const override;
+		void QueryNearest(const Vec3& point, size_t count, std::vector<entt::entity>& out) const override;
+	};
+}
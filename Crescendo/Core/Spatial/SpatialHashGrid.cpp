@@ -0,0 +1,226 @@
+#include "SpatialHashGrid.hpp"
+#include <cmath>
+#include <queue>
+#include <algorithm>
+
+namespace CrescendoEngine
+{
+	std::array<int32_t, 3> SpatialHashGrid::ToCell(const Vec3& position) const
+	{
+		return {
+			static_cast<int32_t>(std::floor(position[0] * m_inverseCellSize)),
+			static_cast<int32_t>(std::floor(position[1] * m_inverseCellSize)),
+			static_cast<int32_t>(std::floor(position[2] * m_inverseCellSize))
+		};
+	}
+	SpatialHashGrid::CellKey SpatialHashGrid::ToKey(int32_t x, int32_t y, int32_t z)
+	{
+		// 21 bits per axis, coordinates wrap beyond +-2^20 cells which only costs extra candidates
+		constexpr uint64_t mask = (1ULL << 21) - 1;
+		return (static_cast<uint64_t>(x) & mask) | ((static_cast<uint64_t>(y) & mask) << 21) | ((static_cast<uint64_t>(z) & mask) << 42);
+	}
+	void SpatialHashGrid::AddToCell(uint32_t slot)
+	{
+		Item& item = m_items[slot];
+		const std::array<int32_t, 3> cell = ToCell(item.position);
+		item.cell = ToKey(cell[0], cell[1], cell[2]);
+		std::vector<uint32_t>& slots = m_cells[item.cell];
+		item.cellSlot = static_cast<uint32_t>(slots.size());
+		slots.push_back(slot);
+	}
+	void SpatialHashGrid::RemoveFromCell(uint32_t slot)
+	{
+		const Item& item = m_items[slot];
+		auto it = m_cells.find(item.cell);
+		std::vector<uint32_t>& slots = it->second;
+		const uint32_t last = slots.back();
+		slots[item.cellSlot] = last;
+		m_items[last].cellSlot = item.cellSlot;
+		slots.pop_back();
+		if (slots.empty())
+			m_cells.erase(it);
+	}
+	template<typename Func>
+	void SpatialHashGrid::ForEachInCells(const std::array<int32_t, 3>& minCell, const std::array<int32_t, 3>& maxCell, Func&& func) const
+	{
+		const uint64_t cellCount =
+			static_cast<uint64_t>(maxCell[0] - minCell[0] + 1) *
+			static_cast<uint64_t>(maxCell[1] - minCell[1] + 1) *
+			static_cast<uint64_t>(maxCell[2] - minCell[2] + 1);
+
+		// Large ranges are cheaper to answer by walking the occupied cells
+		if (cellCount > m_cells.size())
+		{
+			for (const auto& [key, slots] : m_cells)
+			{
+				for (uint32_t slot : slots)
+					func(slot);
+			}
+			return;
+		}
+
+		for (int32_t z = minCell[2]; z <= maxCell[2]; z++)
+		{
+			for (int32_t y = minCell[1]; y <= maxCell[1]; y++)
+			{
+				for (int32_t x = minCell[0]; x <= maxCell[0]; x++)
+				{
+					auto it = m_cells.find(ToKey(x, y, z));
+					if (it == m_cells.end())
+						continue;
+					for (uint32_t slot : it->second)
+						func(slot);
+				}
+			}
+		}
+	}
+	SpatialHashGrid::SpatialHashGrid(float cellSize) : m_cellSize(cellSize), m_inverseCellSize(1.0f / cellSize) {}
+	void SpatialHashGrid::Update(entt::entity entity, const Vec3& position)
+	{
+		uint32_t slot = GetSlot(entity);
+		if (slot != NULL_INDEX && m_items[slot].entity == entity)
+		{
+			Item& item = m_items[slot];
+			item.position = position;
+			const std::array<int32_t, 3> cell = ToCell(position);
+			if (ToKey(cell[0], cell[1], cell[2]) != item.cell)
+			{
+				RemoveFromCell(slot);
+				AddToCell(slot);
+			}
+			return;
+		}
+
+		if (!m_freeSlots.empty())
+		{
+			slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else
+		{
+			slot = static_cast<uint32_t>(m_items.size());
+			m_items.emplace_back();
+		}
+		m_items[slot].entity = entity;
+		m_items[slot].position = position;
+		AddToCell(slot);
+		SetSlot(entity, slot);
+	}
+	void SpatialHashGrid::Remove(entt::entity entity)
+	{
+		const uint32_t slot = GetSlot(entity);
+		if (slot == NULL_INDEX || m_items[slot].entity != entity)
+			return;
+		RemoveFromCell(slot);
+		m_items[slot].entity = entt::null;
+		m_freeSlots.push_back(slot);
+		SetSlot(entity, NULL_INDEX);
+	}
+	bool SpatialHashGrid::Contains(entt::entity entity) const
+	{
+		const uint32_t slot = GetSlot(entity);
+		return slot != NULL_INDEX && m_items[slot].entity == entity;
+	}
+	size_t SpatialHashGrid::Size() const
+	{
+		return m_items.size() - m_freeSlots.size();
+	}
+	void SpatialHashGrid::Clear()
+	{
+		m_items.clear();
+		m_freeSlots.clear();
+		m_cells.clear();
+		ClearSlots();
+	}
+	void SpatialHashGrid::Reserve(size_t capacity)
+	{
+		m_items.reserve(capacity);
+		m_cells.reserve(capacity);
+	}
+	void SpatialHashGrid::QueryRadius(const Vec3& center, float radius, std::vector<entt::entity>& out) const
+	{
+		const float radiusSquared = radius * radius;
+		ForEachInCells(
+			ToCell({ center[0] - radius, center[1] - radius, center[2] - radius }),
+			ToCell({ center[0] + radius, center[1] + radius, center[2] + radius }),
+			[&](uint32_t slot) {
+				if (DistanceSquared(m_items[slot].position, center) <= radiusSquared)
+					out.push_back(m_items[slot].entity);
+			}
+		);
+	}
+	void SpatialHashGrid::QueryAABB(const AABB& box, std::vector<entt::entity>& out) const
+	{
+		ForEachInCells(ToCell(box.min), ToCell(box.max), [&](uint32_t slot) {
+			if (IsInside(box, m_items[slot].position))
+				out.push_back(m_items[slot].entity);
+		});
+	}
+	void SpatialHashGrid::QueryNearest(const Vec3& point, size_t count, std::vector<entt::entity>& out) const
+	{
+		if (count == 0 || m_cells.empty())
+			return;
+
+		// Max heap of the best candidates so far, by squared distance
+		std::vector<std::pair<float, uint32_t>> best;
+		best.reserve(count + 1);
+		auto consider = [&](uint32_t slot) {
+			const float distance = DistanceSquared(m_items[slot].position, point);
+			if (best.size() < count)
+			{
+				best.emplace_back(distance, slot);
+				std::push_heap(best.begin(), best.end());
+			}
+			else if (distance < best.front().first)
+			{
+				std::pop_heap(best.begin(), best.end());
+				best.back() = { distance, slot };
+				std::push_heap(best.begin(), best.end());
+			}
+		};
+
+		// Search rings of cells around the point, every point outside ring r is at least r cells away
+		const std::array<int32_t, 3> center = ToCell(point);
+		for (int32_t ring = 0; ; ring++)
+		{
+			const uint64_t side = static_cast<uint64_t>(2 * ring + 1);
+			if (side * side * side > m_cells.size())
+			{
+				// The ring now covers more cells than are occupied, finish with a scan over every item
+				best.clear();
+				for (const auto& [key, slots] : m_cells)
+				{
+					for (uint32_t slot : slots)
+						consider(slot);
+				}
+				break;
+			}
+
+			for (int32_t z = -ring; z <= ring; z++)
+			{
+				for (int32_t y = -ring; y <= ring; y++)
+				{
+					const bool onShell = std::abs(z) == ring || std::abs(y) == ring;
+					// Interior rows only need their two end cells
+					const int32_t step = onShell ? 1 : std::max(2 * ring, 1);
+					for (int32_t x = -ring; x <= ring; x += step)
+					{
+						auto it = m_cells.find(ToKey(center[0] + x, center[1] + y, center[2] + z));
+						if (it == m_cells.end())
+							continue;
+						for (uint32_t slot : it->second)
+							consider(slot);
+					}
+				}
+			}
+
+			const float searched = static_cast<float>(ring) * m_cellSize;
+			if (best.size() == count && best.front().first <= searched * searched)
+				break;
+		}
+
+		std::sort_heap(best.begin(), best.end());
+		for (const auto& [distance, slot] : best)
+			out.push_back(m_items[slot].entity);
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <unordered_map>
+#include "SpatialIndex.hpp"
+
+namespace CrescendoEngine
+{
+	// Uniform grid of cubic cells stored in a hash map, so memory scales with occupied cells rather than world size.
+	// Moving within a cell is O(1), crossing a cell boundary is an O(1) swap-remove and append.
+	// Works best when query radii are within a few cell sizes
+	class CS_CORE_EXPORT SpatialHashGrid : public SpatialIndex
+	{
+	private:
+		using CellKey = uint64_t;
+		struct CellKeyHash
+		{
+			size_t operator()(CellKey key) const
+			{
+				key ^= key >> 33;
+				key *= 0xff51afd7ed558ccdULL;
+				key ^= key >> 33;
+				return static_cast<size_t>(key);
+			}
+		};
+		struct Item
+		{
+			entt::entity entity;
+			Vec3 position;
+			CellKey cell;
+			// Position of the item inside its cell
+			uint32_t cellSlot;
+		};
+	private:
+		float m_cellSize;
+		float m_inverseCellSize;
+		std::vector<Item> m_items;
+		std::vector<uint32_t> m_freeSlots;
+		// Item slots in each occupied cell, empty cells are erased
+		std::unordered_map<CellKey, std::vector<uint32_t>, CellKeyHash> m_cells;
+	private:
+		std::array<int32_t, 3> ToCell(const Vec3& position) const;
+		static CellKey ToKey(int32_t x, int32_t y, int32_t z);
+		void AddToCell(uint32_t slot);
+		void RemoveFromCell(uint32_t slot);
+		// Calls func(slot) for every item in cells overlapping [minCell, maxCell]
+		template<typename Func>
+		void ForEachInCells(const std::array<int32_t, 3>& minCell, const std::array<int32_t, 3>& maxCell, Func&& func) const;
+	public:
+		explicit SpatialHashGrid(float cellSize = 1.0f);
+
+		void Update(entt::entity entity, const Vec3& position) override;
+		void Remove(entt::entity entity) override;
+		bool Contains(entt::entity entity) const override;
+		size_t Size() const override;
+		void Clear() override;
+		// Preallocates room for the given number of entities
+		void Reserve(size_t capacity);
+
+		void QueryRadius(const Vec3& center, float radius, std::vector<entt::entity>& out) const override;
+		void QueryAABB(const AABB& box, std::vector<entt::entity>& out) const override;
+		void QueryNearest(const Vec3& point, size_t count, std::vector<entt::entity>& out) const override;
+	};
+}
@@ -0,0 +1,91 @@
+#include "SpatialIndex.hpp"
+#include <algorithm>
+#include "ECS/Position.hpp"
+#include "Threading/ThreadPool.hpp"
+
+namespace CrescendoEngine
+{
+	namespace
+	{
+		template<typename Query, typename Func>
+		void RunBatch(std::span<const Query> queries, std::vector<std::vector<entt::entity>>& results, ThreadPool* pool, size_t grainSize, Func&& func)
+		{
+			results.resize(queries.size());
+			auto runRange = [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++)
+				{
+					results[i].clear();
+					func(queries[i], results[i]);
+				}
+			};
+			if (pool)
+				pool->ParallelFor(queries.size(), grainSize, runRange);
+			else
+				runRange(0, queries.size());
+		}
+	}
+
+	uint32_t SpatialIndex::GetSlot(entt::entity entity) const
+	{
+		const size_t id = static_cast<size_t>(entt::to_entity(entity));
+		return id < m_sparse.size() ? m_sparse[id] : NULL_INDEX;
+	}
+	void SpatialIndex::SetSlot(entt::entity entity, uint32_t slot)
+	{
+		const size_t id = static_cast<size_t>(entt::to_entity(entity));
+		if (id >= m_sparse.size())
+			m_sparse.resize(id + 1, NULL_INDEX);
+		m_sparse[id] = slot;
+	}
+	void SpatialIndex::ClearSlots()
+	{
+		m_sparse.clear();
+	}
+	float SpatialIndex::DistanceSquared(const Vec3& a, const Vec3& b)
+	{
+		const float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+		return dx * dx + dy * dy + dz * dz;
+	}
+	float SpatialIndex::DistanceSquared(const AABB& box, const Vec3& point)
+	{
+		float distance = 0.0f;
+		for (size_t axis = 0; axis < 3; axis++)
+		{
+			const float delta = std::max({ box.min[axis] - point[axis], 0.0f, point[axis] - box.max[axis] });
+			distance += delta * delta;
+		}
+		return distance;
+	}
+	bool SpatialIndex::IsInside(const AABB& box, const Vec3& point)
+	{
+		return point[0] >= box.min[0] && point[0] <= box.max[0] &&
+			point[1] >= box.min[1] && point[1] <= box.max[1] &&
+			point[2] >= box.min[2] && point[2] <= box.max[2];
+	}
+	void SpatialIndex::QueryRadiusBatch(std::span<const RadiusQuery> queries, std::vector<std::vector<entt::entity>>& results, ThreadPool* pool, size_t grainSize) const
+	{
+		RunBatch(queries, results, pool, grainSize, [this](const RadiusQuery& query, std::vector<entt::entity>& out) {
+			QueryRadius(query.center, query.radius, out);
+		});
+	}
+	void SpatialIndex::QueryAABBBatch(std::span<const AABB> queries, std::vector<std::vector<entt::entity>>& results, ThreadPool* pool, size_t grainSize) const
+	{
+		RunBatch(queries, results, pool, grainSize, [this](const AABB& query, std::vector<entt::entity>& out) {
+			QueryAABB(query, out);
+		});
+	}
+	void SpatialIndex::QueryNearestBatch(std::span<const NearestQuery> queries, std::vector<std::vector<entt::entity>>& results, ThreadPool* pool, size_t grainSize) const
+	{
+		RunBatch(queries, results, pool, grainSize, [this](const NearestQuery& query, std::vector<entt::entity>& out) {
+			QueryNearest(query.point, query.count, out);
+		});
+	}
+	void SpatialIndex::OnPositionChanged(entt::registry& registry, entt::entity entity)
+	{
+		Update(entity, registry.get<Position>(entity).value);
+	}
+	void SpatialIndex::OnPositionRemoved(entt::registry&, entt::entity entity)
+	{
+		Remove(entity);
+	}
+}
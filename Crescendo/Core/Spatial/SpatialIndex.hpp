@@ -0,0 +1,79 @@
+#pragma once
+#include <span>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include "entt/entt.hpp"
+#include "OSDetection.hpp"
+
+namespace CrescendoEngine
+{
+	class ThreadPool;
+
+	using Vec3 = std::array<float, 3>;
+
+	struct AABB
+	{
+		Vec3 min;
+		Vec3 max;
+	};
+
+	// Point index over entity positions, kept up to date incrementally.
+	// Queries are const and may run concurrently from any number of threads, but not concurrently with modifications.
+	class CS_CORE_EXPORT SpatialIndex
+	{
+	public:
+		struct RadiusQuery
+		{
+			Vec3 center;
+			float radius;
+		};
+		struct NearestQuery
+		{
+			Vec3 point;
+			size_t count;
+		};
+	protected:
+		static constexpr uint32_t NULL_INDEX = ~uint32_t(0);
+	private:
+		// Maps entity ids to implementation defined slots
+		std::vector<uint32_t> m_sparse;
+	protected:
+		// Returns the slot of the entity, or NULL_INDEX if it is not indexed. Implementations must verify the entity stored in the slot
+		uint32_t GetSlot(entt::entity entity) const;
+		void SetSlot(entt::entity entity, uint32_t slot);
+		void ClearSlots();
+		static float DistanceSquared(const Vec3& a, const Vec3& b);
+		static float DistanceSquared(const AABB& box, const Vec3& point);
+		static bool IsInside(const AABB& box, const Vec3& point);
+	public:
+		virtual ~SpatialIndex() {};
+
+		// Adds an entity, or moves it if it is already indexed
+		virtual void Update(entt::entity entity, const Vec3& position) = 0;
+		// Removes an entity, does nothing if it is not indexed
+		virtual void Remove(entt::entity entity) = 0;
+		// Returns true if the entity is indexed
+		virtual bool Contains(entt::entity entity) const = 0;
+		// Returns the number of indexed entities
+		virtual size_t Size() const = 0;
+		// Removes every entity
+		virtual void Clear() = 0;
+
+		// Appends every entity within radius of center to out
+		virtual void QueryRadius(const Vec3& center, float radius, std::vector<entt::entity>& out) const = 0;
+		// Appends every entity inside the box to out
+		virtual void QueryAABB(const AABB& box, std::vector<entt::entity>& out) const = 0;
+		// Appends up to count entities closest to point to out, nearest first
+		virtual void QueryNearest(const Vec3& point, size_t count, std::vector<entt::entity>& out) const = 0;
+
+		// Runs many queries at once, results[i] holds the answer to queries[i]. Split across the pool when one is given
+		void QueryRadiusBatch(std::span<const RadiusQuery> queries, std::vector<std::vector<entt::entity>>& results, ThreadPool* pool = nullptr, size_t grainSize = 64) const;
+		void QueryAABBBatch(std::span<const AABB> queries, std::vector<std::vector<entt::entity>>& results, ThreadPool* pool = nullptr, size_t grainSize = 64) const;
+		void QueryNearestBatch(std::span<const NearestQuery> queries, std::vector<std::vector<entt::entity>>& results, ThreadPool* pool = nullptr, size_t grainSize = 64) const;
+
+		// Listeners for the Position component signals, connected by EntityRegistry::TrackPositions
+		void OnPositionChanged(entt::registry& registry, entt::entity entity);
+		void OnPositionRemoved(entt::registry&, entt::entity entity);
+	};
+}
@@ -0,0 +1,122 @@
+#include "ThreadPool.hpp"
+#include <atomic>
+#include <algorithm>
+
+namespace CrescendoEngine
+{
+	void ThreadPool::WorkerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock lock(m_mutex);
+				m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+				if (m_stopping && m_tasks.empty())
+					return;
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+			task();
+		}
+	}
+	void ThreadPool::Start(size_t threadCount)
+	{
+		if (threadCount == 0)
+			threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+		m_stopping = false;
+		m_workers.reserve(threadCount);
+		for (size_t i = 0; i < threadCount; i++)
+			m_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+	void ThreadPool::Stop()
+	{
+		{
+			std::scoped_lock lock(m_mutex);
+			m_stopping = true;
+		}
+		m_condition.notify_all();
+		for (std::thread& worker : m_workers)
+			worker.join();
+		m_workers.clear();
+	}
+	ThreadPool::ThreadPool(size_t threadCount)
+	{
+		Start(threadCount);
+	}
+	ThreadPool::~ThreadPool()
+	{
+		Stop();
+	}
+	void ThreadPool::SetThreadCount(size_t threadCount)
+	{
+		Stop();
+		Start(threadCount);
+	}
+	size_t ThreadPool::GetThreadCount() const
+	{
+		return m_workers.size();
+	}
+	void ThreadPool::Submit(std::function<void()> task)
+	{
+		{
+			std::scoped_lock lock(m_mutex);
+			m_tasks.push_back(std::move(task));
+		}
+		m_condition.notify_one();
+	}
+	void ThreadPool::ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& func)
+	{
+		if (count == 0)
+			return;
+		grainSize = std::max<size_t>(grainSize, 1);
+		const size_t chunkCount = (count + grainSize - 1) / grainSize;
+		if (chunkCount == 1 || m_workers.empty())
+		{
+			func(0, count);
+			return;
+		}
+
+		// Shared so that helpers which wake up after all the chunks are taken can still safely read it
+		struct State
+		{
+			std::atomic<size_t> nextChunk = 0;
+			std::atomic<size_t> finishedChunks = 0;
+			// First exception thrown by func, rethrown on the calling thread
+			std::mutex exceptionMutex;
+			std::exception_ptr exception;
+		};
+		auto state = std::make_shared<State>();
+		auto runChunks = [state, count, grainSize, chunkCount, &func] {
+			size_t chunk;
+			while ((chunk = state->nextChunk.fetch_add(1)) < chunkCount)
+			{
+				const size_t begin = chunk * grainSize;
+				try
+				{
+					func(begin, std::min(begin + grainSize, count));
+				}
+				catch (...)
+				{
+					std::scoped_lock lock(state->exceptionMutex);
+					if (!state->exception)
+						state->exception = std::current_exception();
+				}
+				if (state->finishedChunks.fetch_add(1) + 1 == chunkCount)
+					state->finishedChunks.notify_all();
+			}
+		};
+
+		const size_t helpers = std::min(m_workers.size(), chunkCount - 1);
+		for (size_t i = 0; i < helpers; i++)
+			Submit(runChunks);
+		runChunks();
+
+		// func is only referenced while a chunk is being run, so it is safe to return once every chunk has finished
+		size_t finished;
+		while ((finished = state->finishedChunks.load()) < chunkCount)
+			state->finishedChunks.wait(finished);
+		if (state->exception)
+			std::rethrow_exception(state->exception);
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <deque>
+#include <mutex>
+#include <future>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <type_traits>
+#include <condition_variable>
+#include "OSDetection.hpp"
+
+namespace CrescendoEngine
+{
+	// Fixed size pool of worker threads shared by the engine for data parallel work
+	class CS_CORE_EXPORT ThreadPool
+	{
+	private:
+		std::vector<std::thread> m_workers;
+		std::deque<std::function<void()>> m_tasks;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_stopping = false;
+	private:
+		void WorkerLoop();
+		void Start(size_t threadCount);
+		void Stop();
+	public:
+		// Creates the pool with threadCount workers, 0 uses one less than the hardware concurrency
+		explicit ThreadPool(size_t threadCount = 0);
+		~ThreadPool();
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Finishes the queued tasks and restarts the pool with threadCount workers, 0 uses the default.
+		// Only call while nothing else is using the pool, Core does so at startup
+		void SetThreadCount(size_t threadCount);
+		// Returns the number of worker threads, not counting the calling thread
+		size_t GetThreadCount() const;
+		// Queues a task to be run on a worker thread
+		void Submit(std::function<void()> task);
+		// Queues a callable and returns a future to its result
+		template<typename Func>
+		auto Async(Func&& func) -> std::future<std::invoke_result_t<std::decay_t<Func>>>
+		{
+			using Result = std::invoke_result_t<std::decay_t<Func>>;
+			auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Func>(func));
+			std::future<Result> future = task->get_future();
+			Submit([task] { (*task)(); });
+			return future;
+		}
+		// Splits [0, count) into chunks of at least grainSize and runs func(begin, end) on each, blocking until all are done.
+		// The calling thread takes part and can finish every chunk alone, so this is safe to call from inside a worker.
+		// If func throws, the remaining chunks still run and the first exception is rethrown on the calling thread
+		void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& func);
+	};
+}
@@ -0,0 +1,51 @@
+#include "World.hpp"
+#include <algorithm>
+
+namespace CrescendoEngine
+{
+	void World::MessageBuffer::Push(WorldId world, entt::id_type type, const void* data, size_t size)
+	{
+		const size_t offset = bytes.size();
+		bytes.resize(offset + size);
+		std::memcpy(bytes.data() + offset, data, size);
+		headers.push_back({ world, type, static_cast<uint32_t>(offset), static_cast<uint32_t>(size) });
+	}
+	void World::MessageBuffer::Clear()
+	{
+		headers.clear();
+		bytes.clear();
+	}
+	void World::Step(double dt)
+	{
+		m_time += dt;
+		for (SystemEntry& entry : m_systems)
+			entry.system(*this, dt);
+		// Worlds run on worker threads, so the hierarchy is propagated serially within the world
+		m_registry.GetTransformHierarchy().Propagate();
+	}
+	World::World(WorldId id, std::string name) : m_id(id), m_name(std::move(name)) {}
+	WorldId World::GetId() const
+	{
+		return m_id;
+	}
+	const std::string& World::GetName() const
+	{
+		return m_name;
+	}
+	EntityRegistry& World::GetEntityRegistry()
+	{
+		return m_registry;
+	}
+	double World::GetTime() const
+	{
+		return m_time;
+	}
+	void World::AddSystem(std::string name, System system)
+	{
+		m_systems.push_back({ std::move(name), std::move(system) });
+	}
+	void World::RemoveSystem(const std::string& name)
+	{
+		std::erase_if(m_systems, [&name](const SystemEntry& entry) { return entry.name == name; });
+	}
+}
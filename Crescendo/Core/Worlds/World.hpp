@@ -0,0 +1,103 @@
+#pragma once
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <functional>
+#include <type_traits>
+#include "entt/entt.hpp"
+#include "OSDetection.hpp"
+#include "ECS/EntityRegistry.hpp"
+
+namespace CrescendoEngine
+{
+	using WorldId = uint32_t;
+
+	// Isolated simulation with its own registry and system schedule. Worlds are stepped concurrently by the
+	// WorldManager, so systems may only touch their own world and must not call main thread only APIs.
+	// Worlds talk to each other exclusively through messages, which are delivered between steps
+	class CS_CORE_EXPORT World
+	{
+	public:
+		// Target that delivers a message to every other world
+		static constexpr WorldId BROADCAST = ~WorldId(0);
+		using System = std::function<void(World& world, double dt)>;
+	private:
+		friend class WorldManager;
+		struct MessageHeader
+		{
+			// Target while in the outbox, sender once delivered
+			WorldId world;
+			entt::id_type type;
+			uint32_t offset;
+			uint32_t size;
+		};
+		struct SystemEntry
+		{
+			std::string name;
+			System system;
+		};
+		// Messages are packed into one byte buffer per direction, so sending does not allocate per message
+		struct MessageBuffer
+		{
+			std::vector<MessageHeader> headers;
+			std::vector<std::byte> bytes;
+
+			void Push(WorldId world, entt::id_type type, const void* data, size_t size);
+			void Clear();
+		};
+	private:
+		WorldId m_id;
+		std::string m_name;
+		EntityRegistry m_registry;
+		std::vector<SystemEntry> m_systems;
+		MessageBuffer m_inbox;
+		MessageBuffer m_outbox;
+		double m_time = 0.0;
+	private:
+		void Step(double dt);
+	public:
+		World(WorldId id, std::string name);
+		World(const World&) = delete;
+		World& operator=(const World&) = delete;
+
+		WorldId GetId() const;
+		const std::string& GetName() const;
+		EntityRegistry& GetEntityRegistry();
+		// Returns the simulated time of this world, in seconds
+		double GetTime() const;
+
+		// Appends a system to the schedule, systems run in the order they were added
+		void AddSystem(std::string name, System system);
+		// Removes every system with the given name
+		void RemoveSystem(const std::string& name);
+
+		// Queues a message for another world, or BROADCAST, delivered before that world's next step
+		template<typename T>
+		void Send(WorldId target, const T& message)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "World messages must be trivially copyable");
+			m_outbox.Push(target, entt::type_hash<T>::value(), &message, sizeof(T));
+		}
+		// Calls func(sender, message) for every message of type T delivered for this step, in a deterministic order
+		template<typename T, typename Func>
+		void ForEachMessage(Func&& func) const
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "World messages must be trivially copyable");
+			const entt::id_type type = entt::type_hash<T>::value();
+			for (const MessageHeader& header : m_inbox.headers)
+			{
+				if (header.type != type)
+					continue;
+				// The payload may be misaligned in the byte buffer. Copying into raw storage instead of a default
+				// constructed T also allows messages without a default constructor
+				alignas(T) std::byte storage[sizeof(T)];
+				std::memcpy(storage, m_inbox.bytes.data() + header.offset, sizeof(T));
+				const T& message = *std::launder(reinterpret_cast<const T*>(storage));
+				func(header.world, message);
+			}
+		}
+	};
+}
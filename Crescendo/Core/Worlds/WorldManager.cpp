@@ -0,0 +1,84 @@
+#include "WorldManager.hpp"
+#include <algorithm>
+#include "Console.hpp"
+#include "Threading/ThreadPool.hpp"
+
+namespace CrescendoEngine
+{
+	void WorldManager::DeliverMessages()
+	{
+		for (auto& world : m_worlds)
+			world->m_inbox.Clear();
+
+		// Worlds are visited in id order and each outbox in send order, so delivery order is deterministic
+		for (auto& sender : m_worlds)
+		{
+			World::MessageBuffer& outbox = sender->m_outbox;
+			for (const World::MessageHeader& header : outbox.headers)
+			{
+				const std::byte* data = outbox.bytes.data() + header.offset;
+				if (header.world == World::BROADCAST)
+				{
+					for (auto& receiver : m_worlds)
+					{
+						if (receiver.get() != sender.get())
+							receiver->m_inbox.Push(sender->m_id, header.type, data, header.size);
+					}
+					continue;
+				}
+				if (World* receiver = GetWorld(header.world))
+					receiver->m_inbox.Push(sender->m_id, header.type, data, header.size);
+			}
+			outbox.Clear();
+		}
+	}
+	WorldManager::WorldManager(ThreadPool& threadPool) : m_threadPool(threadPool) {}
+	World& WorldManager::CreateWorld(std::string name)
+	{
+		if (m_stepping)
+			Console::Fatal<std::logic_error>("Cannot create a world while worlds are being stepped");
+		return *m_worlds.emplace_back(std::make_unique<World>(m_nextId++, std::move(name)));
+	}
+	void WorldManager::DestroyWorld(WorldId id)
+	{
+		if (m_stepping)
+			Console::Fatal<std::logic_error>("Cannot destroy a world while worlds are being stepped");
+		auto it = std::lower_bound(m_worlds.begin(), m_worlds.end(), id, [](const auto& world, WorldId id) { return world->GetId() < id; });
+		if (it != m_worlds.end() && (*it)->GetId() == id)
+			m_worlds.erase(it);
+	}
+	World* WorldManager::GetWorld(WorldId id)
+	{
+		auto it = std::lower_bound(m_worlds.begin(), m_worlds.end(), id, [](const auto& world, WorldId id) { return world->GetId() < id; });
+		return (it != m_worlds.end() && (*it)->GetId() == id) ? it->get() : nullptr;
+	}
+	size_t WorldManager::GetWorldCount() const
+	{
+		return m_worlds.size();
+	}
+	void WorldManager::Step(double dt)
+	{
+		if (m_worlds.empty())
+			return;
+
+		m_stepping = true;
+		try
+		{
+			m_threadPool.ParallelFor(m_worlds.size(), 1, [this, dt](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++)
+					m_worlds[i]->Step(dt);
+			});
+		}
+		catch (...)
+		{
+			m_stepping = false;
+			throw;
+		}
+		m_stepping = false;
+		DeliverMessages();
+	}
+	void WorldManager::Clear()
+	{
+		m_worlds.clear();
+	}
+}
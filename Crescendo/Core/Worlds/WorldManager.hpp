@@ -0,0 +1,42 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <string>
+#include "World.hpp"
+#include "OSDetection.hpp"
+
+namespace CrescendoEngine
+{
+	class ThreadPool;
+
+	// Owns every World and steps them in parallel, one world per task, then routes their messages.
+	// All methods are main thread only
+	class CS_CORE_EXPORT WorldManager
+	{
+	private:
+		ThreadPool& m_threadPool;
+		// Sorted by id, ids are never reused
+		std::vector<std::unique_ptr<World>> m_worlds;
+		WorldId m_nextId = 0;
+		bool m_stepping = false;
+	private:
+		void DeliverMessages();
+	public:
+		explicit WorldManager(ThreadPool& threadPool);
+		WorldManager(const WorldManager&) = delete;
+		WorldManager& operator=(const WorldManager&) = delete;
+
+		// Creates an empty world
+		World& CreateWorld(std::string name);
+		// Destroys a world, messages still addressed to it are dropped
+		void DestroyWorld(WorldId id);
+		// Returns the world with the given id, or nullptr
+		World* GetWorld(WorldId id);
+		// Returns the number of worlds
+		size_t GetWorldCount() const;
+		// Steps every world concurrently, then delivers the messages they sent
+		void Step(double dt);
+		// Destroys every world, called by Core before modules are unloaded
+		void Clear();
+	};
+}
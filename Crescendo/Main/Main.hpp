@@ -15,17 +15,19 @@ struct DummyComponent : public Component
 
 class Main : public Module
 {
+private:
+	ServiceHandle<WindowManagerInterface> m_windowManager;
 public:
 	void OnLoad() override
 	{
 		EntityRegistry& registry = Core::Get()->GetEntityRegistry();
+		registry.RegisterComponentName<DummyComponent>("DummyComponent");
 
 		Entity entity = registry.CreateEntity();
 		entity.EmplaceComponent<DummyComponent>(5.0f);
 
-		Module* windowManager = Core::Get()->GetModule("WindowManager");
-
-		dynamic_cast<WindowManagerInterface*>(windowManager)->CreateWindow(800, 600, "Test");
+		m_windowManager = Core::Get()->GetServiceHandle<WindowManagerInterface>();
+		m_windowManager->CreateWindow(800, 600, "Test");
 
 	}
 	void OnUnload() override
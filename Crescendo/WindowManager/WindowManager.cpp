@@ -11,6 +11,7 @@ void WindowManager::OnLoad()
 		Console::Error("Failed to initialize GLFW");
 		Core::Get()->RequestShutdown();
 	}
+	Core::Get()->RegisterService<WindowManagerInterface>(this);
 }
 void WindowManager::OnUpdate(double dt)
 {
@@ -18,6 +19,7 @@ void WindowManager::OnUpdate(double dt)
 }
 void WindowManager::OnUnload()
 {
+	Core::Get()->UnregisterService<WindowManagerInterface>();
 	glfwTerminate();
 }
 ModuleMetadata WindowManager::GetMetadata()
@@ -29,7 +31,8 @@ ModuleMetadata WindowManager::GetMetadata()
 		"GLFW window manager for Crescendo",
 		"Joshua Usi",
 		"",
-		0.001 // 1000 Hz
+		0.001, // 1000 Hz
+		UpdateAffinity::MainThread // GLFW event polling must happen on the main thread
 	};
 }
 
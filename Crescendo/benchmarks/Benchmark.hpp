@@ -0,0 +1,32 @@
+#pragma once
+#include <limits>
+#include <algorithm>
+#include "timestamp.hpp"
+
+namespace CrescendoEngine::Benchmark
+{
+	// Runs func repetitions times and returns the fastest run in milliseconds
+	template<typename Func>
+	double Measure(size_t repetitions, Func&& func)
+	{
+		double best = std::numeric_limits<double>::max();
+		for (size_t i = 0; i < repetitions; i++)
+		{
+			Timestamp timestamp;
+			func();
+			best = std::min(best, timestamp.elapsed() * 1000.0);
+		}
+		return best;
+	}
+	// Consumes a result so the work producing it cannot be optimised away
+	template<typename T>
+	void Consume(const T& value)
+	{
+		static volatile T sink;
+		sink = value;
+		(void)sink;
+	}
+
+	void RunSoABenchmarks();
+	void RunSpatialBenchmarks();
+}
@@ -0,0 +1,83 @@
+#include <span>
+#include <vector>
+#include <iomanip>
+#include "Console.hpp"
+#include "Benchmark.hpp"
+#include "ECS/EntityRegistry.hpp"
+#include "SIMD/Kernels.hpp"
+
+namespace CrescendoEngine::Benchmark
+{
+	namespace
+	{
+		// Same single float update as DummyComponent, plus the velocity integrated into it
+		struct Body : public Component
+		{
+			float x = 0.0f;
+			float velocity = 0.0f;
+
+			CS_SOA_FIELDS(&Body::x, &Body::velocity)
+		};
+
+		constexpr float DT = 1.0f / 60.0f;
+		constexpr size_t REPETITIONS = 20;
+
+		const char* GetLevelName(SIMDLevel level)
+		{
+			switch (level)
+			{
+			case SIMDLevel::Scalar: return "Scalar";
+			case SIMDLevel::SSE2: return "SSE2";
+			case SIMDLevel::AVX2: return "AVX2";
+			}
+			return "Unknown";
+		}
+	}
+
+	// x += velocity * dt over every entity, through the AoS ForEach and through ForEachSoA + SIMD::Axpy at each level
+	void RunSoABenchmarks()
+	{
+		const SIMDLevel supported = SIMD::GetSupportedLevel();
+		Console::Log("SoA integration benchmark, best of ", REPETITIONS, " runs, CPU supports ", GetLevelName(supported));
+
+		for (size_t count : { size_t(10'000), size_t(100'000), size_t(1'000'000) })
+		{
+			EntityRegistry registry;
+			for (size_t i = 0; i < count; i++)
+			{
+				Entity entity = registry.CreateEntity();
+				Body body;
+				body.x = static_cast<float>(i);
+				body.velocity = 1.0f;
+				entity.EmplaceComponent<Body>(body);
+				registry.AddSoAComponent(entity, body);
+			}
+
+			const double aos = Measure(REPETITIONS, [&] {
+				registry.ForEach<Body>(std::function<void(Body&)>([](Body& body) {
+					body.x += body.velocity * DT;
+				}));
+			});
+			float checksum = 0.0f;
+			registry.ForEach<Body>(std::function<void(Body&)>([&](Body& body) { checksum += body.x; }));
+			Consume(checksum);
+			Console::Log(std::setw(9), count, " entities  AoS ForEach     ", std::fixed, std::setprecision(3), aos, " ms");
+
+			for (SIMDLevel level : { SIMDLevel::Scalar, SIMDLevel::SSE2, SIMDLevel::AVX2 })
+			{
+				if (level > supported)
+					continue;
+				SIMD::SetLevel(level);
+				const double soa = Measure(REPETITIONS, [&] {
+					registry.ForEachSoA<Body>([](std::span<float> x, std::span<float> velocity) {
+						SIMD::Axpy(DT, velocity.data(), x.data(), x.size());
+					});
+				});
+				Consume(registry.GetSoAStorage<Body>().Field<0>()[count - 1]);
+				Console::Log(std::setw(9), count, " entities  SoA ", std::left, std::setw(12), GetLevelName(level), std::right,
+					std::fixed, std::setprecision(3), soa, " ms  ", std::setprecision(1), aos / soa, "x");
+			}
+		}
+		SIMD::SetLevel(supported);
+	}
+}
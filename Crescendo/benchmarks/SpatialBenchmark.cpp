@@ -0,0 +1,241 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <iterator>
+#include <iomanip>
+#include <algorithm>
+#include <string>
+#include "Console.hpp"
+#include "Benchmark.hpp"
+#include "ECS/EntityRegistry.hpp"
+#include "Spatial/SpatialHashGrid.hpp"
+#include "Spatial/DynamicBVH.hpp"
+#include "Threading/ThreadPool.hpp"
+
+namespace CrescendoEngine::Benchmark
+{
+	namespace
+	{
+		// Entities are spread uniformly at one per unit cube, so a radius query returns about 34 entities at every size
+		constexpr float RADIUS = 2.0f;
+		constexpr size_t NEAREST = 8;
+		constexpr size_t QUERY_COUNT = 256;
+		constexpr size_t REPETITIONS = 3;
+
+		using Results = std::vector<std::vector<entt::entity>>;
+
+		// Keeps the count closest candidates seen so far, farthest on top of the heap
+		class NearestHeap
+		{
+		private:
+			std::vector<std::pair<float, entt::entity>> m_items;
+			size_t m_count = 0;
+		public:
+			void Reset(size_t count)
+			{
+				m_items.clear();
+				m_count = count;
+			}
+			void Push(float distanceSquared, entt::entity entity)
+			{
+				if (m_items.size() < m_count)
+				{
+					m_items.emplace_back(distanceSquared, entity);
+					std::push_heap(m_items.begin(), m_items.end());
+				}
+				else if (distanceSquared < m_items.front().first)
+				{
+					std::pop_heap(m_items.begin(), m_items.end());
+					m_items.back() = { distanceSquared, entity };
+					std::push_heap(m_items.begin(), m_items.end());
+				}
+			}
+			void Write(std::vector<entt::entity>& out)
+			{
+				std::sort_heap(m_items.begin(), m_items.end());
+				for (const auto& [distance, entity] : m_items)
+					out.push_back(entity);
+			}
+		};
+
+		float DistanceSquared(const Vec3& a, const Vec3& b)
+		{
+			const float x = a[0] - b[0], y = a[1] - b[1], z = a[2] - b[2];
+			return x * x + y * y + z * z;
+		}
+		size_t CountResults(const Results& results)
+		{
+			size_t total = 0;
+			for (const std::vector<entt::entity>& result : results)
+				total += result.size();
+			return total;
+		}
+		// Returns the number of queries whose entities differ from the expected ones, ignoring order. Sorts both in place
+		size_t CountMismatches(Results& results, Results& expected)
+		{
+			size_t mismatches = 0;
+			for (size_t i = 0; i < results.size(); i++)
+			{
+				std::sort(results[i].begin(), results[i].end());
+				std::sort(expected[i].begin(), expected[i].end());
+				if (results[i] != expected[i])
+					mismatches++;
+			}
+			return mismatches;
+		}
+		void Report(const char* name, double milliseconds, double baseline)
+		{
+			const double microseconds = milliseconds * 1000.0 / QUERY_COUNT;
+			Console::Log("      ", std::left, std::setw(22), name, std::right, std::fixed, std::setprecision(3), std::setw(12), microseconds,
+				" us/query  ", std::setprecision(1), baseline / milliseconds, "x");
+		}
+
+		// Brute force answers, one ForEach over every Position per query, or one ForEach answering every query at once
+		void ScanRadius(EntityRegistry& registry, std::span<const SpatialIndex::RadiusQuery> queries, Results& results)
+		{
+			for (size_t i = 0; i < queries.size(); i++)
+			{
+				const SpatialIndex::RadiusQuery query = queries[i];
+				std::vector<entt::entity>& out = results[i];
+				out.clear();
+				registry.ForEach<Position>(std::function<void(entt::entity, Position&)>([&](entt::entity entity, Position& position) {
+					if (DistanceSquared(position.value, query.center) <= query.radius * query.radius)
+						out.push_back(entity);
+				}));
+			}
+		}
+		void ScanRadiusBatch(EntityRegistry& registry, std::span<const SpatialIndex::RadiusQuery> queries, Results& results)
+		{
+			for (std::vector<entt::entity>& out : results)
+				out.clear();
+			registry.ForEach<Position>(std::function<void(entt::entity, Position&)>([&](entt::entity entity, Position& position) {
+				for (size_t i = 0; i < queries.size(); i++)
+				{
+					if (DistanceSquared(position.value, queries[i].center) <= queries[i].radius * queries[i].radius)
+						results[i].push_back(entity);
+				}
+			}));
+		}
+		void ScanNearest(EntityRegistry& registry, std::span<const SpatialIndex::NearestQuery> queries, Results& results)
+		{
+			NearestHeap heap;
+			for (size_t i = 0; i < queries.size(); i++)
+			{
+				const SpatialIndex::NearestQuery query = queries[i];
+				heap.Reset(query.count);
+				registry.ForEach<Position>(std::function<void(entt::entity, Position&)>([&](entt::entity entity, Position& position) {
+					heap.Push(DistanceSquared(position.value, query.point), entity);
+				}));
+				results[i].clear();
+				heap.Write(results[i]);
+			}
+		}
+		void ScanNearestBatch(EntityRegistry& registry, std::span<const SpatialIndex::NearestQuery> queries, Results& results)
+		{
+			std::vector<NearestHeap> heaps(queries.size());
+			for (size_t i = 0; i < queries.size(); i++)
+				heaps[i].Reset(queries[i].count);
+			registry.ForEach<Position>(std::function<void(entt::entity, Position&)>([&](entt::entity entity, Position& position) {
+				for (size_t i = 0; i < queries.size(); i++)
+					heaps[i].Push(DistanceSquared(position.value, queries[i].point), entity);
+			}));
+			for (size_t i = 0; i < queries.size(); i++)
+			{
+				results[i].clear();
+				heaps[i].Write(results[i]);
+			}
+		}
+	}
+
+	// Radius and k-nearest queries through SpatialHashGrid and DynamicBVH against a linear ForEach scan over Position,
+	// one query at a time and as a batch, the index batches both on one thread and split across the thread pool
+	void RunSpatialBenchmarks()
+	{
+		ThreadPool pool;
+		Console::Log("Spatial query benchmark, ", QUERY_COUNT, " queries, best of ", REPETITIONS, " runs, ", pool.GetThreadCount(), " worker threads");
+
+		for (size_t count : { size_t(10'000), size_t(100'000), size_t(1'000'000) })
+		{
+			const float extent = std::cbrt(static_cast<float>(count));
+			std::mt19937 random(12345);
+			std::uniform_real_distribution<float> coordinate(0.0f, extent);
+
+			EntityRegistry registry;
+			for (size_t i = 0; i < count; i++)
+			{
+				const Vec3 position = { coordinate(random), coordinate(random), coordinate(random) };
+				registry.CreateEntity().EmplaceComponent<Position>(position[0], position[1], position[2]);
+			}
+
+			SpatialHashGrid grid(RADIUS);
+			DynamicBVH bvh;
+			grid.Reserve(count);
+			bvh.Reserve(count);
+			const double gridBuild = Measure(1, [&] { registry.TrackPositions(grid); });
+			const double bvhBuild = Measure(1, [&] { registry.TrackPositions(bvh); });
+			registry.UntrackPositions(grid);
+			registry.UntrackPositions(bvh);
+
+			std::vector<SpatialIndex::RadiusQuery> radiusQueries;
+			std::vector<SpatialIndex::NearestQuery> nearestQueries;
+			for (size_t i = 0; i < QUERY_COUNT; i++)
+			{
+				const Vec3 point = { coordinate(random), coordinate(random), coordinate(random) };
+				radiusQueries.push_back({ point, RADIUS });
+				nearestQueries.push_back({ point, NEAREST });
+			}
+
+			const SpatialIndex* indices[] = { &grid, &bvh };
+			const char* names[] = { "SpatialHashGrid", "DynamicBVH" };
+			Results expected(QUERY_COUNT), results(QUERY_COUNT);
+			// Times the scan, then every index. Batched queries are timed on the calling thread alone and split across the
+			// pool, so the single threaded scan has a like for like row. Each query's entities are compared against the
+			// scan so a broken index cannot look fast
+			auto compare = [&](auto&& scan, auto&& query, bool batched) {
+				const double baseline = Measure(REPETITIONS, scan);
+				Report("Linear scan", baseline, baseline);
+				for (size_t i = 0; i < std::size(indices); i++)
+				{
+					for (ThreadPool* threads : { static_cast<ThreadPool*>(nullptr), &pool })
+					{
+						if (threads && !batched)
+							break;
+						const double time = Measure(REPETITIONS, [&] { query(*indices[i], threads); });
+						Consume(CountResults(results));
+						Report(threads ? (std::string(names[i]) + ", pool").c_str() : names[i], time, baseline);
+						if (const size_t mismatches = CountMismatches(results, expected))
+							Console::Error(names[i], " returned different entities than the scan for ", mismatches, " of ", QUERY_COUNT, " queries");
+					}
+				}
+			};
+
+			Console::Log(std::setw(9), count, " entities, built SpatialHashGrid in ", std::fixed, std::setprecision(1), gridBuild,
+				" ms, DynamicBVH in ", bvhBuild, " ms");
+
+			Console::Log("    Radius ", RADIUS, ", single queries");
+			compare([&] { ScanRadius(registry, radiusQueries, expected); }, [&](const SpatialIndex& index, ThreadPool*) {
+				for (size_t i = 0; i < QUERY_COUNT; i++)
+				{
+					results[i].clear();
+					index.QueryRadius(radiusQueries[i].center, radiusQueries[i].radius, results[i]);
+				}
+			}, false);
+			Console::Log("    Radius ", RADIUS, ", batched");
+			compare([&] { ScanRadiusBatch(registry, radiusQueries, expected); }, [&](const SpatialIndex& index, ThreadPool* threads) {
+				index.QueryRadiusBatch(radiusQueries, results, threads);
+			}, true);
+			Console::Log("    ", NEAREST, " nearest, single queries");
+			compare([&] { ScanNearest(registry, nearestQueries, expected); }, [&](const SpatialIndex& index, ThreadPool*) {
+				for (size_t i = 0; i < QUERY_COUNT; i++)
+				{
+					results[i].clear();
+					index.QueryNearest(nearestQueries[i].point, nearestQueries[i].count, results[i]);
+				}
+			}, false);
+			Console::Log("    ", NEAREST, " nearest, batched");
+			compare([&] { ScanNearestBatch(registry, nearestQueries, expected); }, [&](const SpatialIndex& index, ThreadPool* threads) {
+				index.QueryNearestBatch(nearestQueries, results, threads);
+			}, true);
+		}
+	}
+}
@@ -0,0 +1,19 @@
+#include <string_view>
+#include "Console.hpp"
+#include "Benchmark.hpp"
+
+using namespace CrescendoEngine;
+
+// Usage: benchmarks [soa|spatial], runs every suite when no name is given
+int main(int argc, char* argv[])
+{
+	Console::Begin();
+	const std::string_view suite = (argc > 1) ? argv[1] : "";
+
+	if (suite.empty() || suite == "soa")
+		Benchmark::RunSoABenchmarks();
+	if (suite.empty() || suite == "spatial")
+		Benchmark::RunSpatialBenchmarks();
+
+	return 0;
+}
@@ -141,6 +141,15 @@ project "Core"
 	files { "./%{wks.name}/thirdparty/simdjson/simdjson.cpp" }
 	applyBuildConfigSettings();
 
+-- Microbenchmarks of the Core data paths, runs standalone without loading any module
+project "benchmarks"
+	location "./%{wks.name}/benchmarks"
+	kind "ConsoleApp"
+	links { "Core" }
+	applyCppSettings()
+	applyBuildsettings()
+	applyBuildConfigSettings();
+
 -- Third party files
 project "thirdparty"
 	location "./%{wks.name}/thirdparty"